@@ -8,731 +8,190 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <ctype.h>
 #include <float.h>
 #include <math.h>
 #include <time.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 // import additional modules
 #include "String.h"
 #include "Stack.h"
-
-// function to spit out an error and kill the program if/when necessary
-void whoops(char *reason) {
-	fputs("\nERROR: ", stderr);
-	fputs(reason, stderr);
-	fputc('\n', stderr);
-	exit(1);
-}
-
-// function to return a new String object containing the contents of a file
-String *read_file(char *path) {
-	// open the script file for reading, or return NULL if it can't be opened
-	FILE *file_pointer = fopen(path, "rb");
-	if (file_pointer == NULL) {
-		return NULL;
-	}
-
-	// seek to the end and get the position after the last character
-	fseek(file_pointer, 0, SEEK_END);
-	long file_size = ftell(file_pointer);
-
-	// return to the start to read the file
-	fseek(file_pointer, 0, SEEK_SET);
-
-	// make a new string to store the script
-	String *file_content = String_new(file_size);
-
-	// store the file contents in the string
-	fread(file_content->content, 1, file_size, file_pointer);
-
-	// close the file so it doesn't reside in memory forever
-	fclose(file_pointer);
-
-	return file_content;
-}
-
-// function to attempt to write a String to a file and return true only if the operation was successful
-bool write_file(char *path, String *new_contents) {
-	// try to open the file for writing and return false if this doesn't happen
-	FILE *file_pointer = fopen(path, "wb");
-	if (file_pointer == NULL) {
-		return false;
-	}
-
-	// return true only if the entire contents were successfully written to the file
-	bool result = fwrite(new_contents->content, 1, new_contents->length, file_pointer) == new_contents->length;
-
-	// close the file so it doesn't reside in memory forever
-	fclose(file_pointer);
-
-	return result;
-}
-
-// numeric type that can represent either long integer or double-precision floating-point values
-typedef struct {
-	bool is_double;
-	union {
-		long value_long;
-		double value_double;
-	};
-} Number;
-
-// function to make and initialise a new Number
-Number *Number_new() {
-	Number *number = malloc(sizeof(Number));
-	number->is_double = false;
-	number->value_long = 0;
-	return number;
-}
-
-// enumeration type used to represent the type of an Element
-typedef enum {
-	ELEMENT_NOTHING,
-
-	ELEMENT_TERMINATOR,
-	ELEMENT_BRACKET,
-	ELEMENT_BRACE,
-
-	ELEMENT_NULL,
-	ELEMENT_VARIABLE,
-	ELEMENT_OPERATION,
-	ELEMENT_STRING,
-	ELEMENT_NUMBER,
-
-	ELEMENT_SEQUENCE,
-
-	ELEMENT_SCOPE_COLLECTION,
-	ELEMENT_SCOPE,
-	ELEMENT_CLOSURE,
-} ElementType;
-
-// type used to store any value that can be encountered by the language, as well as its type and garbage-collection status
-typedef struct {
-	ElementType type;
-	bool gc_checked;
-	void *value;
-} Element;
-
-// function to make and initialise a new Element
-Element *Element_new(ElementType type, void *value) {
-	Element *new_element = malloc(sizeof(Element));
-	new_element->type = type;
-	new_element->gc_checked = false;
-	new_element->value = value;
-	return new_element;
-}
-
-// enumeration type used to represent the type of an Operation
-typedef enum {
-	OPERATION_JUXTAPOSITION,
-	OPERATION_ACCESS,
-	OPERATION_POW,
-	OPERATION_MULTIPLICATION,
-	OPERATION_DIVISION,
-	OPERATION_REMAINDER,
-	OPERATION_ADDITION,
-	OPERATION_SUBTRACTION,
-	OPERATION_SHIFT_LEFT,
-	OPERATION_SHIFT_RIGHT,
-	OPERATION_SUBL,
-	OPERATION_SUBG,
-	OPERATION_CHAR_AT,
-	OPERATION_CHAR_APPEND,
-	OPERATION_LT,
-	OPERATION_GT,
-	OPERATION_LTE,
-	OPERATION_GTE,
-	OPERATION_EQUALITY,
-	OPERATION_INEQUALITY,
-	OPERATION_LIKENESS,
-	OPERATION_BWAND,
-	OPERATION_BWXOR,
-	OPERATION_BWOR,
-	OPERATION_XOR,
-	OPERATION_AND,
-	OPERATION_OR,
-	OPERATION_CLOSURE,
-} OperationType;
+#include "Pool.h"
+#include "Runtime.h"
 
 // array storing the precedence value of each operator
 const int OPERATOR_PRECEDENCE[] = {0, 0, 1, 2, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 7, 7, 8, 8, 8, 9, 10, 11, 12, 13, 14, 15};
 
-// type used to represent an operation that is to be performed on two values
-typedef struct {
-	OperationType type;
-	Element *element_a;
-	Element *element_b;
-} Operation;
-
-// function to make and initialise a new Operation
-Operation *Operation_new(OperationType type, Element *a, Element *b) {
-	Operation *new_operation = malloc(sizeof(Operation));
-	new_operation->type = type;
-	new_operation->element_a = a;
-	new_operation->element_b = b;
-	return new_operation;
-}
-
-// function to perform operations on numbers
-Number* perform_numeric_operation(OperationType operation_type, Number *number_a, Number *number_b) {
-	Number *result = Number_new();
-
-	// the result should usually be a floating-point value if either operand is one already
-	result->is_double = number_a->is_double || number_b->is_double;
-
-	// most of these operations follow the same format:
-	// if one of the operands is floating-point, then perform the operation using the appropriate property for each number (value_double or value_long) depending on the type of number it is
-	// otherwise, just perform the operation using value_long for both numbers
-	switch (operation_type) {
-		case OPERATION_ADDITION:
-			if (result->is_double) {
-				result->value_double =
-					(number_a->is_double ? number_a->value_double : number_a->value_long) +
-					(number_b->is_double ? number_b->value_double : number_b->value_long);
-			} else {
-				result->value_long = number_a->value_long + number_b->value_long;
-			}
-			break;
-		case OPERATION_SUBTRACTION:
-			if (result->is_double) {
-				result->value_double =
-					(number_a->is_double ? number_a->value_double : number_a->value_long) -
-					(number_b->is_double ? number_b->value_double : number_b->value_long);
-			} else {
-				result->value_long = number_a->value_long - number_b->value_long;
-			}
-			break;
-		case OPERATION_MULTIPLICATION:
-			if (result->is_double) {
-				result->value_double =
-					(number_a->is_double ? number_a->value_double : number_a->value_long) *
-					(number_b->is_double ? number_b->value_double : number_b->value_long);
-			} else {
-				result->value_long = number_a->value_long * number_b->value_long;
-			}
-			break;
-		case OPERATION_DIVISION:
-			// if the denomintor is zero or there is no clean integer division, make the result floating-point
-			if (number_b->value_long == 0 || number_a->value_long % number_b->value_long != 0) {
-				result->is_double = true;
-			}
-
-			if (result->is_double) {
-				// if the result needs to be floating-point, convert the operands to floating-point
-				double double_a = number_a->is_double ? number_a->value_double : number_a->value_long;
-				double double_b = number_b->is_double ? number_b->value_double : number_b->value_long;
-
-				// if the denominator is zero, use the appropriate infinity value
-				// otherwise, perform regular floating-point division
-				result->value_double = double_b == 0 ? (double_a == 0 ? NAN : double_a > 0 ? INFINITY : -INFINITY) : double_a / double_b;
-			} else {
-				// if the two values are normal integers and the denominator isn't zero, just use integer division
-				result->value_long = number_a->value_long / number_b->value_long;
-			}
-			break;
-
-		case OPERATION_REMAINDER:
-			// the remainder operator only applies to integers
-			if (result->is_double) {
-				whoops("cannot apply remainder operation to floating-point values");
-			} else {
-				result->value_long = number_a->value_long % number_b->value_long;
-			}
-			break;
-
-		case OPERATION_POW:
-			// the pow() function only works on doubles and only returns a double, so the result is a double
-			result->is_double = true;
-
-			// convert each operand to a double
-			double double_a = number_a->is_double ? number_a->value_double : number_a->value_long;
-			double double_b = number_b->is_double ? number_b->value_double : number_b->value_long;
-
-			result->value_double = pow(double_a, double_b);
-			break;
-
-		case OPERATION_LT:
-		case OPERATION_GT:
-			// switch the operands around for the other operator so we don't have to write the same logic twice
-			if (operation_type == OPERATION_GT) {
-				Number *temp = number_a;
-				number_a = number_b;
-				number_b = temp;
-			}
-
-			// the result will only be 1/0 for true/false so it should be an integer
-			result->is_double = false;
-
-			result->value_long =
-				(number_a->is_double ? number_a->value_double : number_a->value_long) <
-				(number_b->is_double ? number_b->value_double : number_b->value_long);
-			break;
-
-		case OPERATION_LTE:
-		case OPERATION_GTE:
-			// switch the operands around for the other operator so we don't have to write the same logic twice
-			if (operation_type == OPERATION_GTE) {
-				Number *temp = number_a;
-				number_a = number_b;
-				number_b = temp;
-			}
-
-			// the result will only be 1/0 for true/false so it should be an integer
-			result->is_double = false;
+// function to convert a hex digit into the number it represents (returned as a char)
+char hex_char(char hex_char) {
+	// uppercase letters represent 10-15, so get the index of the letter relative to 'A' and add 10
+	if (hex_char >= 97) {
+		return hex_char - 97 + 10;
+	}
 
-			result->value_long =
-				(number_a->is_double ? number_a->value_double : number_a->value_long) <=
-				(number_b->is_double ? number_b->value_double : number_b->value_long);
-			break;
+	// lowercase letters also represent 10-15, so get the index of the letter relative to 'a' and add 10
+	if (hex_char >= 65) {
+		return hex_char - 65 + 10;
 	}
 
-	return result;
+	// decimal digits represent 0-9, so just get the index of the digit relative to '0'
+	return hex_char - 48;
 }
 
-// type used to represent an association between a key and a value
-typedef struct {
-	Element *key;
-	Element *value;
-} Map;
-
-// type used to represent a scope of variables or an object with properties depending on usage
+// type used to refer to a run of characters without copying them, such as the characters of a token inside a script
 typedef struct {
+	unsigned char *content;
 	size_t length;
-	Map maps[];
-} Scope;
-
-// function to make and initialise a new Scope object
-Scope *Scope_new() {
-	Scope *new_scope = malloc(sizeof(Scope));
-	new_scope->length = 0;
-	return new_scope;
-}
-
-// forward declaration of get_scope_mapping() for mutual recursion
-Element *get_scope_mapping(Scope*, Element*);
-
-// function to compare two Elements a and b
-bool compare_elements(Element *element_a, Element *element_b) {
-	// handle the case where at least one of the elements is invalid
-	if (element_a == NULL || element_b == NULL) {
-		return false;
-	}
-
-	// if the same Element is being passed to both arguments, then they are equal
-	if (element_a == element_b) {
-		return true;
-	}
-
-	// elements must be of the same type to be equal
-	if (element_a->type != element_b->type) {
-		return false;
-	}
-
-	switch (element_a->type) {
-		case ELEMENT_NULL:
-			// there is only one value that Null Elements can be, and we already know that the type is the same, so these elements must be equal
-			return true;
+} Span;
 
-		case ELEMENT_VARIABLE:
-		case ELEMENT_STRING:
-			// string-like values can be compared by comparing their lengths and each character in them
-			{
-				String *string_a = element_a->value;
-				String *string_b = element_b->value;
-
-				// if the lengths are different, the strings are different
-				if (string_a->length != string_b->length) {
-					return false;
-				}
-
-				// iterate through each character in both strings and if any character differs, then the strings differ
-				for (size_t i = 0; i < string_a->length; i++) {
-					if (string_a->content[i] != string_b->content[i]) {
-						return false;
-					}
-				}
-
-				// if each corresponding character is equal and the lengths are equal, the string must be equal
-				return true;
-			};
-			break;
-
-		case ELEMENT_NUMBER:
-			{
-				Number *number_a = element_a->value;
-				Number *number_b = element_b->value;
-
-				// each number can be either a double or long, so each combination of doubles and longs must be considered
-				if (number_a->is_double) {
-					if (number_b->is_double) {
-						return number_a->value_double == number_b->value_double;
-					} else {
-						return number_a->value_double == number_b->value_long;
-					}
-				} else {
-					if (number_b->is_double) {
-						return number_a->value_long == number_b->value_double;
-					} else {
-						return number_a->value_long == number_b->value_long;
-					}
-				}
-			};
-			break;
+// function to check if the characters in a Span match a constant char array
+bool Span_is(Span span, char *char_array) {
+	return strlen(char_array) == span.length && memcmp(span.content, char_array, span.length) == 0;
+}
 
-		case ELEMENT_SCOPE:
-			{
-				Scope *scope_a = element_a->value;
-				Scope *scope_b = element_b->value;
+// powers of ten that can all be represented exactly by a double
+const double exact_powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
-				// scopes with differing numbers of mappings must not be equal
-				if (scope_a->length != scope_b->length) {
-					return false;
-				}
+// function to convert the characters of a number token into a Number
+// like atoi() and atof(), it reads an optional minus sign followed by digits and stops at the first character that can't be part of the number
+Number parse_number(Span token) {
+	Number number = {0};
 
-				// the scopes are not equal if any of the mappings differ
-				for (size_t i = 0; i < scope_a->length; i++) {
-					if (!compare_elements(get_scope_mapping(scope_b, scope_a->maps[i].key), scope_a->maps[i].value)) {
-						return false;
-					}
-				}
+	size_t i = 0;
 
-				// if the lengths are the same and the mappings are the same, the scopes must be equal
-				return true;
-			};
-			break;
+	bool negative = token.length > 0 && token.content[0] == '-';
+	if (negative) {
+		i++;
 	}
 
-	// Elements that for whatever reason cannot be compared are considered non-equal
-	return false;
-}
+	// if there's a decimal point anywhere then it's floating-point, otherwise it's an integer
+	number.is_double = memchr(token.content, '.', token.length) != NULL;
 
-// function to edit the mapping within a Scope for a certain key, creating one if it doesn't exist yet
-Scope *set_scope_mapping(Scope *scope, Element *key, Element *value) {
-	// iterate through the scope and update the value of a matching Map if one is found
-	for (size_t i = 0; i < scope->length; i++) {
-		if (compare_elements(scope->maps[i].key, key)) {
-			scope->maps[i].value = value;
-			return scope;
+	if (!number.is_double) {
+		unsigned long value = 0;
+		for (; i < token.length && isdigit(token.content[i]); i++) {
+			value = value * 10 + (token.content[i] - '0');
 		}
-	}
-
-	// if no matching Map is found, more memory must be allocated for an additional Map
-	scope = realloc(scope, sizeof(Scope) + (scope->length + 1) * sizeof(Map));
-
-	// configure the properties of the new Map so that it maps the key to the new value
-	scope->maps[scope->length].key = key;
-	scope->maps[scope->length].value = value;
-
-	scope->length++;
 
-	return scope;
-}
-
-// function to get a value mapped to a certain key in a Scope
-Element *get_scope_mapping(Scope *scope, Element *key) {
-	// search through all mappings in the Scope and return the value of one if the keys match
-	for (size_t i = 0; i < scope->length; i++) {
-		if (compare_elements(scope->maps[i].key, key)) {
-			return scope->maps[i].value;
-		}
+		number.value_long = negative ? -(long)value : (long)value;
+		return number;
 	}
 
-	// otherwise, there is no matching element, so return NULL
-	return NULL;
-}
-
-// function to determine whether or not a mapping is present within a Scope with a matching key
-bool check_scope_mapping(Scope *scope, Element *key) {
-	// search through all mappings in the Scope and return true if one with a matching key is present
-	for (size_t i = 0; i < scope->length; i++) {
-		if (compare_elements(scope->maps[i].key, key)) {
-			return true;
+	// read every digit on both sides of the decimal point into a single integer, keeping track of how many came after the decimal point
+	unsigned long mantissa = 0;
+	size_t digits = 0;
+	size_t fraction_digits = 0;
+	bool in_fraction = false;
+
+	for (; i < token.length; i++) {
+		if (isdigit(token.content[i])) {
+			mantissa = mantissa * 10 + (token.content[i] - '0');
+			digits++;
+			fraction_digits += in_fraction;
+		} else if (token.content[i] == '.' && !in_fraction) {
+			in_fraction = true;
+		} else {
+			break;
 		}
 	}
 
-	// no matches were found
-	return false;
-}
+	// if both the integer and the power of ten can be represented exactly, a single division gives a correctly rounded result
+	// otherwise, fall back to atof() on a null-terminated copy of the characters
+	if (digits <= 15 && fraction_digits < sizeof(exact_powers_of_ten) / sizeof(double)) {
+		number.value_double = mantissa / exact_powers_of_ten[fraction_digits];
 
-// function to delete a mapping in a Scope
-Scope *delete_scope_mapping(Scope *scope, Element *key) {
-	bool shift_back = false;
-
-	// iterate through the Scope until the matching mapping is found
-	// after that, shift every mapping back one place
-	for (size_t i = 0; i < scope->length; i++) {
-		if (shift_back) {
-			scope->maps[i - 1].key = scope->maps[i].key;
-			scope->maps[i - 1].value = scope->maps[i].value;
-		} else if (compare_elements(scope->maps[i].key, key)) {
-			shift_back = true;
+		if (negative) {
+			number.value_double = -number.value_double;
 		}
-	}
+	} else {
+		char number_string[token.length + 1];
+		memcpy(number_string, token.content, token.length);
+		number_string[token.length] = '\0';
 
-	// if no matching key was ever found, do not shrink the scope
-	if (!shift_back) {
-		return scope;
+		number.value_double = atof(number_string);
 	}
 
-	// reduce the size of the scope by one mapping's worth
-	scope->length--;
-	scope = realloc(scope, sizeof(Scope) + scope->length * sizeof(Map));
-
-	return scope;
+	return number;
 }
 
-// function to print Elements to the console based on their type
-void print_value(Element *element, int indentation, bool literal) {
-	// make sure that the Element actually exists first
-	if (element == NULL) {
-		return;
-	}
-
-	switch (element->type) {
-		case ELEMENT_NULL:
-			putchar('(');
-			putchar(')');
-			break;
-
-		case ELEMENT_NUMBER:
-			{
-				Number *number = element->value;
-
-				if (number->is_double) {
-					// if the number is a floating-point value, print it to the maximum number of decimal places necessary to represent it exactly
-					printf("%.*g", DBL_DECIMAL_DIG, number->value_double);
-				} else {
-					// if the number is a long integer, just print it
-					printf("%ld", number->value_long);
-				}
-			};
-			break;
-
-		case ELEMENT_VARIABLE:
-			// print the name of the variable as it is
-			String_print(element->value);
-			break;
-
-		case ELEMENT_STRING:
-			if (literal) {
-				// if we are supposed to print the Element as a literal element, print it as a correctly-formatted ash-script string
-
-				String *string = element->value;
-
-				putchar('"');
-
-				for (size_t i = 0; i < string->length; i++) {
-					// when a quote is found, it should be escaped by a backslash
-					if (string->content[i] == '"') {
-						putchar('\\');
-					}
-
-					// re-create some of the escape sequences
-					if (string->content[i] == '\n') {
-						putchar('\\');
-						putchar('n');
-					} else if (string->content[i] == '\r') {
-						putchar('\\');
-						putchar('r');
-					} else if (string->content[i] == '\t') {
-						putchar('\\');
-						putchar('t');
-					} else {
-						putchar(string->content[i]);
-					}
+// type used to make sure that every variable name with the same characters is represented by the same Element
+typedef struct {
+	// open-addressing hash table of variable Elements, where empty buckets are NULL
+	Element **elements;
+	size_t capacity;
+	size_t length;
+} InternTable;
+
+// function to get the variable Element for a certain name, making a new one if the name hasn't been seen before
+// the name is only copied into a new String if a new Element has to be made
+Element *intern_variable(InternTable *table, Span name, Heap *heap) {
+	// grow the table once it is half full, so that there are always plenty of empty buckets to end each search
+	if (table->length * 2 >= table->capacity) {
+		Element **old_elements = table->elements;
+		size_t old_capacity = table->capacity;
+
+		table->capacity = old_capacity == 0 ? 64 : old_capacity * 2;
+		table->elements = calloc(table->capacity, sizeof(Element*));
+
+		// move every Element into its bucket in the new table
+		for (size_t i = 0; i < old_capacity; i++) {
+			if (old_elements[i] != NULL) {
+				size_t bucket = String_hash(old_elements[i]->value) & (table->capacity - 1);
+				while (table->elements[bucket] != NULL) {
+					bucket = (bucket + 1) & (table->capacity - 1);
 				}
-
-				putchar('"');
-			} else {
-				// otherwise, just dump the contents to the console
-				String_print(element->value);
+				table->elements[bucket] = old_elements[i];
 			}
-			break;
-
-		case ELEMENT_SCOPE:
-			{
-				Scope *scope = element->value;
-
-				putchar('{');
-				putchar('\n');
-
-				// iterate through all the mappings in the Scope
-				for (size_t i = 0; i < scope->length; i++) {
-					// correctly indent each line of the Scope
-					for (int i = 0; i < indentation + 1; i++) {
-						putchar('\t');
-					}
-
-					// print a 'let' statement defining each key and value in the scope
-					fputs("let ", stdout);
-					print_value(scope->maps[i].key, indentation + 1, true);
-					putchar(' ');
-					print_value(scope->maps[i].value, indentation + 1, true);
-					putchar(';');
-					putchar('\n');
-				}
-
-				// correctly indent the last line of the Scope
-				for (int i = 0; i < indentation; i++) {
-					putchar('\t');
-				}
-
-				putchar('}');
-			};
-			break;
-
-		case ELEMENT_SEQUENCE:
-			{
-				Stack *sequence = element->value;
-
-				putchar('{');
-				putchar('\n');
-
-				// iterate through each statement in the sequence and print it
-				for (size_t i = 0; i < sequence->length; i++) {
-					Stack *statement = sequence->content[i];
-
-					// correctly indent each line of the Scope
-					for (int i = 0; i < indentation + 1; i++) {
-						putchar('\t');
-					}
-
-					// iterate through each Element in the statement and print it
-					for (size_t i = 0; i < statement->length; i++) {
-						print_value(statement->content[i], indentation + 1, true);
-						putchar(' ');
-					}
-
-					putchar(';');
-					putchar('\n');
-				}
-
-				// correctly indent the last line of the Sequence
-				for (int i = 0; i < indentation; i++) {
-					putchar('\t');
-				}
-
-				putchar('}');
-			};
-			break;
-
-		case ELEMENT_OPERATION:
-			{
-				Operation *operation = element->value;
-
-				putchar('(');
-				print_value(operation->element_a, indentation, true);
-
-				// since we only get to print Operations if we're debugging the parsing logic, it's good enough to just print a placeholder indicating which operation it is
-				printf(" [%d] ", operation->type);
-
-				print_value(operation->element_b, indentation, true);
-				putchar(')');
-			};
-			break;
-
-		case ELEMENT_CLOSURE:
-			// Closures can't easily be represented in text due to their Scope-containing nature, so just print a placeholder
-			fputs("[=>]", stdout);
-			break;
-
-		default:
-			// if the Element does not have its type listed above, print a placeholder indicating its type
-			printf("[E %d]", element->type);
-	}
-}
-
-// function to determine whether or not an Element has a truthy value
-bool value_is_truthy(Element *element) {
-	switch (element->type) {
-		case ELEMENT_NULL:
-			// Null Elements are never truthy
-			return false;
-
-		case ELEMENT_NUMBER:
-			// Number Elements are truthy if they do not equal 0 or NAN
-			{
-				Number *number = element->value;
-
-				if (number->is_double) {
-					return number->value_double != 0 && number->value_double != NAN;
-				} else {
-					return number->value_long != 0;
-				}
-			};
-			break;
-		case ELEMENT_STRING:
-			// String Elements are truthy if they are not empty
-			{
-				String *string = element->value;
-
-				return string->length != 0;
-			};
-			break;
-		case ELEMENT_SCOPE:
-			// Scope Elements are truthy if they contain at least one mapping
-			{
-				Scope *scope = element->value;
+		}
 
-				return scope->length != 0;
-			};
-			break;
+		free(old_elements);
 	}
 
-	// all Elements of any other type are considered truthy
-	return true;
-}
+	// check each bucket from the one that the name hashes to until either the name or an empty bucket is found
+	size_t hash = String_hash_content(name.content, name.length);
+	size_t bucket = hash & (table->capacity - 1);
+	while (table->elements[bucket] != NULL) {
+		String *existing_name = table->elements[bucket]->value;
 
-// type used to represent a Closure, which is a function that stores within itself the Scopes surrounding it
-// this means that variables in the Scopes in which the Closure was created can be accessed by the Closure when it is called
-typedef struct {
-	Element *expression;
-	Element *variable;
-	Element *scopes;
-} Closure;
-
-// function to make and initialise a new Closure object
-Closure *Closure_new(Element *expression, Element *variable, Element *scopes) {
-	Closure *new_closure = malloc(sizeof(Closure));
-	new_closure->expression = expression;
-	new_closure->variable = variable;
-	new_closure->scopes = scopes;
-	return new_closure;
-}
+		if (existing_name->hash == hash && existing_name->length == name.length && memcmp(existing_name->content, name.content, name.length) == 0) {
+			return table->elements[bucket];
+		}
 
-// function to convert a hex digit into the number it represents (returned as a char)
-char hex_char(char hex_char) {
-	// uppercase letters represent 10-15, so get the index of the letter relative to 'A' and add 10
-	if (hex_char >= 97) {
-		return hex_char - 97 + 10;
+		bucket = (bucket + 1) & (table->capacity - 1);
 	}
 
-	// lowercase letters also represent 10-15, so get the index of the letter relative to 'a' and add 10
-	if (hex_char >= 65) {
-		return hex_char - 65 + 10;
-	}
+	String *new_name = String_from(name.content, name.length);
+	new_name->hash = hash;
 
-	// decimal digits represent 0-9, so just get the index of the digit relative to '0'
-	return hex_char - 48;
-}
+	table->elements[bucket] = make(ELEMENT_VARIABLE, new_name, heap);
+	table->length++;
 
-// function that makes a new element with a specific type and value, and pushes it to a stack so that it can be garbage collected later
-Element *make(ElementType type, void *value, Stack **heap) {
-	Element *new_element = Element_new(type, value);
-	*heap = Stack_push(*heap, new_element);
-	return new_element;
+	return table->elements[bucket];
 }
 
 // function to convert a script string into a list of tokens that an abstract syntax tree can be easily constructed from
-Stack *tokenise(String *script, Stack **heap) {
+Stack *tokenise(String *script, Heap *heap) {
 	// stack to store the new tokens
 	Stack *tokens = Stack_new();
 
 	// these store the type and value of the current element we are dealing with
+	// the value of the current element is usually a run of characters in the script itself, so it doesn't need to be copied anywhere until the element is made
 	ElementType current_type;
-	String *current_value = String_new(0);
+	Span current_value = {NULL, 0};
+
+	// buffer that the value of the current element is copied into if its characters aren't all next to each other in the script, which happens when it contains an escape sequence or a comment
+	// since escape sequences and comments only ever make a value shorter than the characters it came from, the buffer never needs to be bigger than the script
+	unsigned char *copied_value = malloc(script->length + 1);
+
+	// table of the variable Elements made so far
+	InternTable variable_names = {NULL, 0, 0};
 
 	// whether we are in an escape sequence or not
 	bool escaped = false;
@@ -918,41 +377,42 @@ Stack *tokenise(String *script, Stack **heap) {
 		// if we've reached the end of a token, we need to add it to the token list and start making a new token
 		// we've reached the end of a token if we've got one to begin with and if there's been a change in the token type
 		// brackets, braces and semicolons can also trigger the end of a token, since they cannot be part of a variable name
-		if ((current_value->length > 0 || in_string) && (new_type != current_type ||
+		if ((current_value.length > 0 || in_string) && (new_type != current_type ||
 					current_type == ELEMENT_BRACKET ||
 					current_type == ELEMENT_BRACE ||
 					current_type == ELEMENT_TERMINATOR
 					)) {
 
 			// add a new element to the program's internally-managed heap
-			Element *new_token = make(current_type, NULL, heap);
+			// numbers and variables are made separately below, since numbers store their value within the Element itself and variables are interned
+			Element *new_token = current_type == ELEMENT_NUMBER || current_type == ELEMENT_VARIABLE ? NULL : make(current_type, NULL, heap);
 
 			// figure out the value of the token based on its type
 			switch (current_type) {
 				case ELEMENT_NULL:
 				case ELEMENT_TERMINATOR:
 					// nulls and terminators don't contain any meaningful characters
-					free(current_value);
 					break;
 
 				case ELEMENT_VARIABLE:
+					// every occurrence of the same variable name uses the same Element, so that variable names can be compared by their location
+					new_token = intern_variable(&variable_names, current_value, heap);
+					break;
+
 				case ELEMENT_STRING:
-					// variables and strings contain their own characters
-					new_token->value = current_value;
+					// strings contain their own copy of their characters
+					new_token->value = String_from(current_value.content, current_value.length);
 					break;
 
 				case ELEMENT_BRACKET:
 				case ELEMENT_BRACE:
 					// brackets and braces only need to keep track of whether they are opening or closing
 					{
-						char bracket_character = current_value->content[0];
+						char bracket_character = current_value.content[0];
 
 						// usually, Element structs use their 'value' pointer to point to the value of the element
 						// however, since bracket and brace elements are only either opening or closing, I figured it would be slightly more efficient to store this within the pointer value itself, instead of making another object on the heap
 						new_token->value = (void*)(uintptr_t)(bracket_character == '}' || bracket_character == ')');
-
-						// brackets and braces don't need to store their characters
-						free(current_value);
 					};
 					break;
 
@@ -964,94 +424,70 @@ Stack *tokenise(String *script, Stack **heap) {
 
 						// match the new operator to its operation type
 						// I apologise for this ugly monstrosity but it's necessary because C can't concisely switch-case with entire strings
-						if (String_is(current_value, "+")) {
+						if (Span_is(current_value, "+")) {
 							operation->type = OPERATION_ADDITION;
-						} else if (String_is(current_value, "-")) {
+						} else if (Span_is(current_value, "-")) {
 							operation->type = OPERATION_SUBTRACTION;
-						} else if (String_is(current_value, "*")) {
+						} else if (Span_is(current_value, "*")) {
 							operation->type = OPERATION_MULTIPLICATION;
-						} else if (String_is(current_value, "/")) {
+						} else if (Span_is(current_value, "/")) {
 							operation->type = OPERATION_DIVISION;
-						} else if (String_is(current_value, "%")) {
+						} else if (Span_is(current_value, "%")) {
 							operation->type = OPERATION_REMAINDER;
-						} else if (String_is(current_value, "==")) {
+						} else if (Span_is(current_value, "==")) {
 							operation->type = OPERATION_EQUALITY;
-						} else if (String_is(current_value, "<")) {
+						} else if (Span_is(current_value, "<")) {
 							operation->type = OPERATION_LT;
-						} else if (String_is(current_value, ">")) {
+						} else if (Span_is(current_value, ">")) {
 							operation->type = OPERATION_GT;
-						} else if (String_is(current_value, "<=")) {
+						} else if (Span_is(current_value, "<=")) {
 							operation->type = OPERATION_LTE;
-						} else if (String_is(current_value, ">=")) {
+						} else if (Span_is(current_value, ">=")) {
 							operation->type = OPERATION_GTE;
-						} else if (String_is(current_value, "!=")) {
+						} else if (Span_is(current_value, "!=")) {
 							operation->type = OPERATION_INEQUALITY;
-						} else if (String_is(current_value, "<<")) {
+						} else if (Span_is(current_value, "<<")) {
 							operation->type = OPERATION_SHIFT_LEFT;
-						} else if (String_is(current_value, ">>")) {
+						} else if (Span_is(current_value, ">>")) {
 							operation->type = OPERATION_SHIFT_RIGHT;
-						} else if (String_is(current_value, "&")) {
+						} else if (Span_is(current_value, "&")) {
 							operation->type = OPERATION_BWAND;
-						} else if (String_is(current_value, "|")) {
+						} else if (Span_is(current_value, "|")) {
 							operation->type = OPERATION_BWOR;
-						} else if (String_is(current_value, "^")) {
+						} else if (Span_is(current_value, "^")) {
 							operation->type = OPERATION_BWXOR;
-						} else if (String_is(current_value, "**")) {
+						} else if (Span_is(current_value, "**")) {
 							operation->type = OPERATION_POW;
-						} else if (String_is(current_value, ">/")) {
+						} else if (Span_is(current_value, ">/")) {
 							operation->type = OPERATION_SUBG;
-						} else if (String_is(current_value, "</")) {
+						} else if (Span_is(current_value, "</")) {
 							operation->type = OPERATION_SUBL;
-						} else if (String_is(current_value, "@")) {
+						} else if (Span_is(current_value, "@")) {
 							operation->type = OPERATION_CHAR_AT;
-						} else if (String_is(current_value, "@@")) {
+						} else if (Span_is(current_value, "@@")) {
 							operation->type = OPERATION_CHAR_APPEND;
-						} else if (String_is(current_value, ".")) {
+						} else if (Span_is(current_value, ".")) {
 							operation->type = OPERATION_ACCESS;
-						} else if (String_is(current_value, "=>")) {
+						} else if (Span_is(current_value, "=>")) {
 							operation->type = OPERATION_CLOSURE;
-						} else if (String_is(current_value, "&&")) {
+						} else if (Span_is(current_value, "&&")) {
 							operation->type = OPERATION_AND;
-						} else if (String_is(current_value, "||")) {
+						} else if (Span_is(current_value, "||")) {
 							operation->type = OPERATION_OR;
-						} else if (String_is(current_value, "^^")) {
+						} else if (Span_is(current_value, "^^")) {
 							operation->type = OPERATION_XOR;
-						} else if (String_is(current_value, "<>=")) {
+						} else if (Span_is(current_value, "<>=")) {
 							operation->type = OPERATION_LIKENESS;
 						}
 
 						// set the value of the token to its new Operation object
 						new_token->value = operation;
-
-						// we're done with the value string now
-						free(current_value);
 					};
 					break;
 
 				case ELEMENT_NUMBER:
 					// numbers need to be converted to Number elements that store integers or floats
-					{
-						Number *number = Number_new();
-
-						// copy the number contents into a null-terminated char array so we can process them using atof and atoi
-						char number_string[current_value->length + 1];
-						memcpy(number_string, current_value->content, current_value->length);
-						number_string[current_value->length] = '\0';
-
-						// if there's a decimal point then it's floating-point, otherwise it's an integer
-						if (String_has_char(current_value, '.')) {
-							number->is_double = true;
-							number->value_double = atof(number_string);
-						} else {
-							number->value_long = atoi(number_string);
-						}
-
-						// set the value of the token to its new Number object
-						new_token->value = number;
-
-						// we're done with the value string now
-						free(current_value);
-					};
+					new_token = make_number(parse_number(current_value), heap);
 					break;
 			}
 
@@ -1060,7 +496,7 @@ Stack *tokenise(String *script, Stack **heap) {
 
 			// reset the token variables so we can make a new one
 			current_type = ELEMENT_NOTHING;
-			current_value = String_new(0);
+			current_value.length = 0;
 		}
 
 		// we no longer need to check for differences in token types, so update the current type
@@ -1068,7 +504,27 @@ Stack *tokenise(String *script, Stack **heap) {
 
 		// if the current character is not whitespace and we are either fully inside or fully outside a string, add the character to the current token
 		if (current_type != ELEMENT_NOTHING && (in_string || current_type != ELEMENT_STRING)) {
-			current_value = String_append_char(current_value, c);
+			bool in_script = i < script->length && script->content[i] == c;
+
+			if (current_value.length == 0 && in_script) {
+				// start a new value at the current character in the script
+				current_value.content = &script->content[i];
+				current_value.length = 1;
+			} else if (in_script && current_value.content + current_value.length == &script->content[i]) {
+				// the current character comes straight after the rest of the value in the script, so the value just needs to be extended
+				current_value.length++;
+			} else {
+				// otherwise, the value has to be copied into the buffer so that the character can be added to the end of it
+				if (current_value.content != copied_value) {
+					if (current_value.length > 0) {
+						memcpy(copied_value, current_value.content, current_value.length);
+					}
+					current_value.content = copied_value;
+				}
+
+				copied_value[current_value.length] = c;
+				current_value.length++;
+			}
 		}
 
 		// if we've just entered a String, set the in_string boolean to reflect that
@@ -1078,94 +534,116 @@ Stack *tokenise(String *script, Stack **heap) {
 		escaped = false;
 	}
 
-	// free up the memory used for temporarily storing token values
-	free(current_value);
+	// free up the memory used for temporarily storing token values and finding variable names
+	free(copied_value);
+	free(variable_names.elements);
 
 	return tokens;
 }
 
-// function to handle the construction of a hierarchy of operations from a list of tokens
-Element *operatify(Stack *expression, size_t start, size_t end, Stack **heap) {
-	if (start - end <= 0) {
+// function to check whether an element of an expression is an operator that takes an operand on either side of it
+// application and access-like operators have the lowest precedence level and are handled separately, since they bind more tightly than anything else
+bool is_infix_operator(Element *element) {
+	if (element->type != ELEMENT_OPERATION) {
+		return false;
+	}
+
+	Operation *operation = element->value;
+
+	// operations that have already been given operands, such as bracketed expressions, are just values
+	return operation->element_a == NULL && OPERATOR_PRECEDENCE[operation->type] > 0;
+}
+
+// function to construct a chain of property access operators and/or applications by juxtaposition, which are all left-associative
+// the chain is read from its last element backwards so that the outermost operation is made first, and each operation is then given the rest of the chain as its first operand
+Element *operatify_operand(Stack *expression, size_t start, size_t end, Heap *heap) {
+	if (start == end) {
 		whoops("not enough operands");
 	}
 
-	// if there is only one element in the expression, then it's the return value
-	if (end - start == 1) {
-		return expression->content[start];
+	Element *result = NULL;
+
+	// location that the operation (or value) made in the next step should be stored in
+	Element **operand = &result;
+
+	size_t i = end;
+
+	while (i - start > 1) {
+		Element *second_last_element = expression->content[i - 2];
+		Element *next_operation;
+
+		if (second_last_element->type == ELEMENT_OPERATION && ((Operation*)second_last_element->value)->element_a == NULL) {
+			// if the second last element is a fresh operation, then it must be an access-like operation
+			next_operation = second_last_element;
+			((Operation*)next_operation->value)->element_b = expression->content[i - 1];
+			i -= 2;
+		} else {
+			// otherwise, treat it as application by juxtaposition
+			next_operation = make(ELEMENT_OPERATION, Operation_new(OPERATION_JUXTAPOSITION, NULL, expression->content[i - 1]), heap);
+			i -= 1;
+		}
+
+		*operand = next_operation;
+		operand = &((Operation*)next_operation->value)->element_a;
 	}
 
-	Element *final_element = NULL;
+	// an access-like operation at the very start of the chain has nothing to access
+	if (i == start) {
+		whoops("not enough operands");
+	}
 
-	Operation *final_operation = NULL;
+	*operand = expression->content[start];
 
-	size_t operation_location = 0;
+	return result;
+}
 
-	int precedence_record = 0;
+// function to construct the operations in an expression by precedence climbing, starting from a certain location
+// only operators with a precedence value no worse (higher) than the one given are used, so that the caller can handle the rest
+Element *operatify_from(Stack *expression, size_t *i, size_t end, int worst_precedence, Heap *heap) {
+	// find the first operand, which is everything up until the next operator
+	size_t operand_start = *i;
+	while (*i < end && !is_infix_operator(expression->content[*i])) {
+		(*i)++;
+	}
 
-	// iterate through all the possible operators and find the one with the worst (highest) precedence value
-	for (size_t i = start; i < end; i++) {
-		Element *current_token = expression->content[i];
+	Element *result = operatify_operand(expression, operand_start, *i, heap);
 
-		if (current_token->type == ELEMENT_OPERATION) {
-			Operation *current_operation = current_token->value;
+	while (*i < end) {
+		Element *operator_element = expression->content[*i];
+		Operation *operation = operator_element->value;
 
-			bool satisfactory_precedence = false;
+		int precedence = OPERATOR_PRECEDENCE[operation->type];
 
-			int precedence = OPERATOR_PRECEDENCE[current_operation->type];
+		if (precedence > worst_precedence) {
+			break;
+		}
 
-			// only consider operations that have not yet been selected
-			// also only consider operations that are not of the lowest precedence level, which is for application and access-like operators only
-			if (precedence > 0 && current_operation->element_a == NULL) {
-				// the operation with the worst (highest) precedence should be selected first
-				if (final_operation != NULL && final_operation->type == OPERATION_CLOSURE) {
-					// certain operations are right-associative and so the first operation of this precedence level should be selected first
-					satisfactory_precedence = precedence > precedence_record;
-				} else {
-					// otherwise, the operator of this precedence level that occurs last should be selected first
-					satisfactory_precedence = precedence >= precedence_record;
-				}
-			}
+		(*i)++;
 
-			if (satisfactory_precedence) {
-				// update the variables to point to the new record-holding operator
-				final_element = current_token;
-				final_operation = current_operation;
-				precedence_record = precedence;
-				operation_location = i;
-			}
-		}
-	}
+		// most operations are left-associative, so their second operand can only contain operations that bind more tightly than they do
+		// closures are right-associative, so their second operand can also contain other closures
+		int second_worst_precedence = operation->type == OPERATION_CLOSURE ? precedence : precedence - 1;
 
-	// if no operation was found, then this expression must entirely consist of property access operators and/or application by juxtaposition
-	if (final_operation == NULL) {
-		Element *second_last_element = expression->content[end - 2];
+		operation->element_a = result;
+		operation->element_b = operatify_from(expression, i, end, second_worst_precedence, heap);
 
-		if (second_last_element->type == ELEMENT_OPERATION && ((Operation*)second_last_element->value)->element_a == NULL) {
-			// if the second last element is a fresh operation, then it must be an access-like operation
-			final_element = second_last_element;
-			final_operation = second_last_element->value;
-			operation_location = end - 2;
-		} else {
-			// otherwise, treat it as application by juxtaposition
-			return make(ELEMENT_OPERATION, Operation_new(OPERATION_JUXTAPOSITION, operatify(expression, start, end - 1, heap), expression->content[end - 1]), heap);
-		}
+		result = operator_element;
 	}
 
-	// process everything to the left of the operator and use it as its first operand
-	final_operation->element_a = operatify(expression, start, operation_location, heap);
-
-	// process everything to the right of the operator and use it as its second operand
-	final_operation->element_b = operatify(expression, operation_location + 1, end, heap);
+	return result;
+}
 
-	return final_element;
+// function to handle the construction of a hierarchy of operations from a list of tokens
+Element *operatify(Stack *expression, size_t start, size_t end, Heap *heap) {
+	size_t i = start;
+	return operatify_from(expression, &i, end, OPERATOR_PRECEDENCE[OPERATION_CLOSURE], heap);
 }
 
 // forward declaration of elementify_sequence() for mutual recursion
-Element *construct_sequence(Stack*, size_t*, Stack**);
+Element *construct_sequence(Stack*, size_t*, Heap*);
 
 // function to handle the construction of the abstract syntax tree branches of expressions
-Element *construct_expression(Stack *tokens, size_t *i, Stack **heap) {
+Element *construct_expression(Stack *tokens, size_t *i, Heap *heap) {
 	Stack *expression = Stack_new();
 
 	bool end_of_expression = false;
@@ -1226,8 +704,31 @@ Element *construct_expression(Stack *tokens, size_t *i, Stack **heap) {
 	return result;
 }
 
+// function to resolve the command name at the start of a statement into a Command Element
+Element *resolve_command(Element *command, Heap *heap) {
+	// all command names must be plain old words
+	if (command->type != ELEMENT_VARIABLE) {
+		whoops("command name must not be a value");
+	}
+
+	// find the command with a matching name
+	for (size_t i = 0; i < sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]); i++) {
+		if (String_is(command->value, COMMAND_NAMES[i])) {
+			// like brackets and braces, the command is stored within the pointer value itself instead of in another object on the heap
+			return make(ELEMENT_COMMAND, (void*)(uintptr_t)i, heap);
+		}
+	}
+
+	// if no matching command was found for this statement, it must be an invalid command
+	putchar('\n');
+	String_print(command->value);
+	whoops("command not recognised");
+
+	return NULL;
+}
+
 // function to handle the construction of the abstract syntax tree branchs of sequences
-Element *construct_sequence(Stack *tokens, size_t *i, Stack **heap) {
+Element *construct_sequence(Stack *tokens, size_t *i, Heap *heap) {
 	// create a stack to store the sequence of statements
 	Stack *sequence = Stack_new();
 
@@ -1268,7 +769,10 @@ Element *construct_sequence(Stack *tokens, size_t *i, Stack **heap) {
 					// statement-terminating semicolons should finalise the statement
 
 					// only finalise the statement if there is stuff in it
-					if (statement->length >= 0) {
+					if (statement->length > 0) {
+						// resolve the command name now so that it doesn't need to be matched every time the statement is executed
+						statement->content[0] = resolve_command(statement->content[0], heap);
+
 						// add the new statement to the sequence
 						sequence = Stack_push(sequence, statement);
 
@@ -1298,1192 +802,1166 @@ Element *construct_sequence(Stack *tokens, size_t *i, Stack **heap) {
 }
 
 // function to construct the abstract syntax tree from the token list
-Element *construct_tree(Stack *tokens, Stack **heap) {
+Element *construct_tree(Stack *tokens, Heap *heap) {
 	size_t i = 0;
 	return construct_sequence(tokens, &i, heap);
 }
 
-// function to recursively mark items as non-garbage so that the garbage collector doesn't destroy useful data
-void garbage_check(Element *element) {
-	// stop the recursion if a valid element isn't provided or if the element has been visited already
-	if (element == NULL || element->gc_checked) {
-		return;
-	}
-
-	// mark the element as non-garbabge
-	element->gc_checked = true;
-
-	switch (element->type) {
-		case ELEMENT_OPERATION:
-			{
-				Operation *operation = element->value;
-				garbage_check(operation->element_a);
-				garbage_check(operation->element_b);
-			};
-			break;
-		case ELEMENT_SEQUENCE:
-			{
-				Stack *sequence = element->value;
-
-				// iterate through all statements in the sequence
-				for (size_t y = 0; y < sequence->length; y++) {
-					Stack *statement = sequence->content[y];
-
-					// iterate through all Elements in the statement
-					for (size_t x = 0; x < statement->length; x++) {
-						garbage_check(statement->content[x]);
-					}
-				}
-			};
-			break;
-		case ELEMENT_SCOPE_COLLECTION:
-			{
-				Stack *scope_collection = element->value;
-
-				// iterate through all the scopes in the collection and check them
-				for (size_t i = 0; i < scope_collection->length; i++) {
-					garbage_check(scope_collection->content[i]);
-				}
-			};
-			break;
-		case ELEMENT_SCOPE:
-			{
-				Scope *scope = element->value;
-
-				// iterate through all the Maps in the Scope and check the keys and values
-				for (size_t i = 0; i < scope->length; i++) {
-					garbage_check(scope->maps[i].key);
-					garbage_check(scope->maps[i].value);
-				}
-			};
-			break;
-		case ELEMENT_CLOSURE:
-			{
-				Closure *closure = element->value;
-				garbage_check(closure->expression);
-				garbage_check(closure->variable);
-				garbage_check(closure->scopes);
-			};
-			break;
-	}
+// function to make a previously-emitted jump instruction jump to the position of the next instruction to be emitted
+void patch_jump(Program *program, size_t position) {
+	program->code[position].operand = program->length;
 }
 
-// function to free an element and its contents
-void nuke(Element *element) {
-	switch (element->type) {
-		case ELEMENT_NULL:
-		case ELEMENT_BRACKET:
-		case ELEMENT_BRACE:
-			break;
-
-		case ELEMENT_SEQUENCE:
-			{
-				Stack *sequence = element->value;
-
-				// free all the statements in the sequence
-				for (size_t y = 0; y < sequence->length; y++) {
-					free(sequence->content[y]);
-				}
-
-				// free the sequence itself
-				free(sequence);
-			};
-			break;
-
-		default:
-			// most elements only need their value free'd
-			free(element->value);
-	}
-
-	// free the element itself
-	free(element);
+// function to emit an instruction that throws an error when it is executed
+// errors in the structure of statements are only reported when the statement is reached, just like when the syntax tree is walked directly
+void emit_failure(Program *program, char *reason) {
+	emit(program, OPCODE_FAIL, add_constant(program, reason));
 }
 
-// function to clean out any unreferenced garbage that has been building up on the heap tracker
-void garbage_collect(Element *result, Element *ast_root, Stack **keep_stack, Stack **scopes_stack, Stack **heap) {
-	if (result != NULL) {
-		// mark any single result value as non-garbage
-		garbage_check(result);
-	}
-
-	if (ast_root != NULL) {
-		// mark the abstract syntax tree as non-garbage
-		garbage_check(ast_root);
-	}
-
-	if (scopes_stack != NULL) {
-		// mark all the items in scopes as non-garbage
-		for (size_t i = 0; i < (*scopes_stack)->length; i++) {
-			garbage_check((*scopes_stack)->content[i]);
-		}
-	}
-
-	if (keep_stack != NULL) {
-		// mark all the items in the keep stack as non-garbage
-		for (size_t i = 0; i < (*keep_stack)->length; i++) {
-			garbage_check((*keep_stack)->content[i]);
-		}
-	}
-
-	// iterate through all the Elements on the heap tracker
-	for (size_t i = 0; i < (*heap)->length; i++) {
-		Element *element = (*heap)->content[i];
-
-		if (element->gc_checked) {
-			// re-mark non-garbage as potential garbage for next time
-			element->gc_checked = false;
-		} else {
-			// if any Element is found that has not been marked as non-garbage, remove it from the stack and free it
-			*heap = Stack_delete(*heap, i);
-			nuke(element);
+// function to start compiling code that will run in a new Scope whose own statements define the given keys
+void enter_static_scope(Program *program, Stack *names) {
+	StaticScope *scope = malloc(sizeof(StaticScope));
+	scope->names = names;
+	scope->parent = program->scope;
 
-			// since we have just shifted all the eleents after this one in the heap tracker down by one position, shift the current index down by one position
-			i--;
-		}
-	}
+	program->static_scopes = Stack_push(program->static_scopes, scope);
+	program->scope = scope;
 }
 
-// function to set a variable in any of the scopes available in the current evaluation
-// the local_only parameter forces the variable to be set only in the local scope
-void set_variable(Element *key, Element *value, Element *scopes, bool local_only) {
-	if (key->type == ELEMENT_NULL) {
-		return;
-	}
-
-	Stack *scope_collection = scopes->value;
-
-	Element *scope;
-
-	if (local_only) {
-		// if the local_only parameter is set, consider only the most recent scope
-		scope = scope_collection->content[scope_collection->length - 1];
-	} else {
-		bool found = false;
-
-		// search through all scopes from youngest to oldest until a scope is found
-		for (size_t i = scope_collection->length - 1; i < scope_collection->length && !found; i--) {
-			scope = scope_collection->content[i];
-
-			// if this scope has the key, select it
-			if (check_scope_mapping(scope->value, key)) {
-				found = true;
+// function to find out where a variable will be found when it is looked up from the code that is currently being compiled
+// the index of its Address is returned, or -1 if there is no Scope that is known to define it
+long resolve_variable(Program *program, Element *name) {
+	size_t depth = 0;
+
+	// search through the StaticScopes from the innermost to the outermost, just like a variable lookup would
+	for (StaticScope *scope = program->scope; scope != NULL; scope = scope->parent) {
+		for (size_t slot = 0; slot < scope->names->length; slot++) {
+			if (compare_elements(scope->names->content[slot], name)) {
+				// the key that defines the variable is remembered so that the Address can be checked when it is used
+				return add_address(program, scope->names->content[slot], depth, slot);
 			}
 		}
-	}
-
-	// modify the appropriate scope according to the key and value specified
-	scope->value = set_scope_mapping(scope->value, key, value);
-}
-
-// function to retrieve the value of a variable in any of the scopes available in the current evaluation
-Element *get_variable(Element *key, Element *scopes) {
-	Stack *scope_collection = scopes->value;
-
-	// iterate through all scopes from the youngest to the oldest
-	// since size_t is an unsigned integer type, it will overflow to a large positive value when it goes below zero, so the condition for this loop should check for a value greater than the Scope collection length
-	for (size_t i = scope_collection->length - 1; i < scope_collection->length; i--) {
-		Element *scope_element = scope_collection->content[i];
-
-		// retrieve a potential value from the Scope
-		Element *result = get_scope_mapping(scope_element->value, key);
 
-		// if a value for the key was found in this scope, return it
-		if (result != NULL) {
-			return result;
-		}
+		depth++;
 	}
 
-	// if no value was found, print the variable name and an error message
-	putchar('\n');
-	print_value(key, 0, true);
-	whoops("variable not found");
-
-	return NULL;
+	return -1;
 }
 
-// forward declaration of evaluate() for mutual recursion
-Element *evaluate(Element*, Element*, Stack**, Stack**, Stack**);
+// forward declaration of compile_sequence() for mutual recursion
+void compile_sequence(Program*, Element*);
 
-// function to perform an operation on two elements after they have been juxtaposed
-Element *juxtapose(Element *element_a, Element *element_b, Element *ast_root, Stack **keep_stack, Stack **scopes_stack, Stack **heap) {
-	switch (element_a->type) {
-		case ELEMENT_SCOPE:
-			// application of a Scope to any value finds the value associated with the key described by the value to which the Scope is applied
-			{
-				Element *result = get_scope_mapping(element_a->value, element_b);
-				if (result == NULL) {
-					result = make(ELEMENT_NULL, NULL, heap);
-				}
-				return result;
-			};
+// function to compile an expression into instructions that leave its evaluation on top of the value stack
+void compile_expression(Program *program, Element *branch) {
+	switch (branch->type) {
+		case ELEMENT_SEQUENCE:
+			compile_sequence(program, branch);
 			break;
 
-		case ELEMENT_CLOSURE:
-			// application of a Closure to any value calls the Closure with the value
+		case ELEMENT_VARIABLE:
 			{
-				Closure *closure = element_a->value;
+				// look up the variable directly if it's known where it will be, otherwise search for it by name
+				long address = resolve_variable(program, branch);
 
-				Stack *old_scopes = closure->scopes->value;
-
-				// make a copy of the old Scope collection so that future calls of this closure aren't executed with a mutated Scope collection
-				Element *scopes_copy = make(ELEMENT_SCOPE_COLLECTION, Stack_new(), heap);
-				for (size_t i = 0; i < old_scopes->length; i++) {
-					scopes_copy->value = Stack_push(scopes_copy->value, old_scopes->content[i]);
+				if (address >= 0) {
+					emit(program, OPCODE_GET_LEXICAL, address);
+				} else {
+					emit(program, OPCODE_GET_VARIABLE, add_constant(program, branch));
 				}
+			};
+			break;
 
-				// if a variable name has been set, make a new scope containing the variable and its value
-				if (closure->variable != NULL) {
-					Element *scope = make(ELEMENT_SCOPE, Scope_new(), heap);
-
-					scope->value = set_scope_mapping(scope->value, closure->variable, element_b);
+		case ELEMENT_OPERATION:
+			{
+				Operation *operation = branch->value;
 
-					// add the new scope to the new scope collection
-					scopes_copy->value = Stack_push(scopes_copy->value, scope);
+				if (operation->element_a == NULL || operation->element_b == NULL) {
+					emit_failure(program, "misplaced operator (maybe you need to put some brackets around one of your expressions?)");
+					break;
 				}
 
-				// add the new set of scopes to the Scope collection stack
-				*scopes_stack = Stack_push(*scopes_stack, scopes_copy);
-
-				// add the closure to the keep stack so that it isn't garbage collected mid-call
-				*keep_stack = Stack_push(*keep_stack, element_a);
-
-				// evaluate the Closure expression with the new Scope collection
-				Element *result = evaluate(closure->expression, ast_root, keep_stack, scopes_stack, heap);
-
-				// remove the new Scope collection from the Scope collection stack so the previous Scope collection is restored
-				*scopes_stack = Stack_pop(*scopes_stack);
-
-				// the call has ended so it's safe to remove the Closure from the keep stack
-				*keep_stack = Stack_pop(*keep_stack);
+				switch (operation->type) {
+					case OPERATION_JUXTAPOSITION:
+						compile_expression(program, operation->element_a);
+						compile_expression(program, operation->element_b);
+						emit(program, OPCODE_APPLY, 0);
+						break;
 
-				return result;
-			};
-			break;
+					case OPERATION_CLOSURE:
+						{
+							// the body of the Closure is compiled separately once the rest of the program has been compiled, which is when its entry is filled in
+							// if a variable name is not specified, don't bother setting it
+							// otherwise, use the variable name specified
+							Element *variable = operation->element_a->type == ELEMENT_NULL ? NULL : operation->element_a;
 
-		case ELEMENT_STRING:
-			// application of a string to a string concatenates the strings
-			{
-				if (element_b->type != ELEMENT_STRING) {
-					whoops("string concatenation can only be applied to strings");
-				}
+							emit(program, OPCODE_CLOSURE, add_prototype(program, operation->element_b, variable, 0));
+						};
+						break;
 
-				String *string_a = element_a->value;
-				String *string_b = element_b->value;
+					case OPERATION_ACCESS:
+						// only the subject of a property access is evaluated
+						compile_expression(program, operation->element_a);
+						emit(program, OPCODE_ACCESS, add_inline_cache(program, operation->element_b));
+						break;
 
-				// make a new string for the result
-				String *result = String_new(string_a->length + string_b->length);
+					case OPERATION_AND:
+					case OPERATION_OR:
+						{
+							// evaluate the first operand, then skip the second operand if the first one already determines the result
+							compile_expression(program, operation->element_a);
+							size_t jump = emit(program, operation->type == OPERATION_AND ? OPCODE_AND : OPCODE_OR, 0);
+							compile_expression(program, operation->element_b);
+							patch_jump(program, jump);
+						};
+						break;
 
-				// iterate through all the characters in both strings and add them to the result string
-				for (size_t i = 0; i < result->length; i++) {
-					// once the first string is exhausted, move on to the next
-					if (i < string_a->length) {
-						result->content[i] = string_a->content[i];
-					} else {
-						result->content[i] = string_b->content[i - string_a->length];
-					}
+					default:
+						// every other operation evaluates both operands in order before operating on them
+						compile_expression(program, operation->element_a);
+						compile_expression(program, operation->element_b);
+						emit(program, OPCODE_OPERATE, operation->type);
 				}
-
-				// make a new Element for the result string and return it
-				return make(ELEMENT_STRING, result, heap);
 			};
 			break;
 
-		case ELEMENT_NULL:
-			return element_a;
-
 		default:
-			printf("%d", element_a->type);
-			whoops("cannot apply this type to any value");
+			// everything else evaluates to itself
+			emit(program, OPCODE_CONSTANT, add_constant(program, branch));
 	}
-
-	return NULL;
 }
 
-// function to evaluate a branch of the abstract syntax tree
-Element *evaluate(Element *branch, Element *ast_root, Stack **keep_stack, Stack **scopes_stack, Stack **heap) {
-	// get the most recently-added Scope collection from the stack of Scope collections
-	Element *scopes = (*scopes_stack)->content[(*scopes_stack)->length - 1];
-
-	switch (branch->type) {
-		case ELEMENT_SEQUENCE:
-			{
-				// each sequence should have its own local scope
-				Element *scope = make(ELEMENT_SCOPE, Scope_new(), heap);
-				scopes->value = Stack_push(scopes->value, scope);
-
-				Stack *sequence = branch->value;
-
-				// iterate through each statement in the sequence
-				for (size_t statement_index = 0; statement_index < sequence->length; statement_index++) {
-					Stack *statement = sequence->content[statement_index];
-
-					// get the command name, which is the first element in the statement
-					Element *command = statement->content[0];
-
-					// all command names must be plain old words
-					if (command->type != ELEMENT_VARIABLE) {
-						whoops("command name must not be a value");
-					}
-
-					// boolean to indicate whether or not a matching instruction was found
-					bool handled = false;
-
-					if (!handled && String_is(command->value, "do") && (handled = true)) {
-						// iterate through each argument and evaluate it
-						for (size_t i = 1; i < statement->length; i++) {
-							evaluate(statement->content[i], ast_root, keep_stack, scopes_stack, heap);
-						}
-					}
-
-					if (!handled && String_is(command->value, "return") && (handled = true)) {
-						if (statement->length != 2) {
-							whoops("'return' statement requires exactly 1 argument");
-						}
-
-						// evaluate the single expression to determine the result
-						Element *result = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
-
-						// remove the current Sequence's Scope object from the Scope stack
-						scopes->value = Stack_pop(scopes->value);
-
-						return result;
-					}
-
-					if (!handled && String_is(command->value, "print") && (handled = true)) {
-						for (size_t i = 1; i < statement->length; i++) {
-							// print the evaluated values, and print only the contents of strings
-							print_value(evaluate(statement->content[i], ast_root, keep_stack, scopes_stack, heap), 0, false);
-						}
-					}
-
-					if (!handled && String_is(command->value, "show") && (handled = true)) {
-						for (size_t i = 1; i < statement->length; i++) {
-							// print the evaluated values, and format the strings as code
-							print_value(evaluate(statement->content[i], ast_root, keep_stack, scopes_stack, heap), 0, true);
-						}
-					}
-
-					if (!handled && String_is(command->value, "whoops") && (handled = true)) {
-						for (size_t i = 1; i < statement->length; i++) {
-							// print the evaluated values, and print only the contents of strings
-							print_value(evaluate(statement->content[i], ast_root, keep_stack, scopes_stack, heap), 0, false);
-						}
+// function to compile a single statement of a sequence
+// the positions of any jumps made by 'return' statements are added to the returns stack so that they can be pointed to the end of the sequence
+void compile_statement(Program *program, Stack *statement, Stack **returns) {
+	// get the command, which was resolved from the first element in the statement when the syntax tree was constructed
+	CommandType command = (uintptr_t)((Element*)statement->content[0])->value;
+
+	switch (command) {
+		case COMMAND_DO:
+			// evaluate each argument and discard its evaluation
+			for (size_t i = 1; i < statement->length; i++) {
+				compile_expression(program, statement->content[i]);
+				emit(program, OPCODE_POP, 0);
+			}
+			break;
 
-						// throw an error and exit the code
-						whoops("user-defined error");
-					}
+		case COMMAND_RETURN:
+			if (statement->length != 2) {
+				emit_failure(program, "'return' statement requires exactly 1 argument");
+				break;
+			}
 
-					if (!handled && String_is(command->value, "rand") && (handled = true)) {
-						if (statement->length != 2) {
-							whoops("'rand' statement requires exactly 1 argument");
-						}
+			// evaluate the single expression to determine the result, then remove the current Sequence's Scope and jump to the end of the sequence
+			compile_expression(program, statement->content[1]);
+			emit(program, OPCODE_EXIT_SEQUENCE, 0);
+			*returns = Stack_push(*returns, (void*)(uintptr_t)emit(program, OPCODE_JUMP, 0));
+			break;
 
-						Element *key = statement->content[1];
+		case COMMAND_PRINT:
+		case COMMAND_SHOW:
+			// print each evaluation as soon as it has been made, formatting strings as code only for 'show'
+			for (size_t i = 1; i < statement->length; i++) {
+				compile_expression(program, statement->content[i]);
+				emit(program, OPCODE_PRINT, command == COMMAND_SHOW);
+			}
+			break;
 
-						// create a new Number to represent the result
-						Number *result = Number_new();
-						result->is_double = true;
+		case COMMAND_WHOOPS:
+			for (size_t i = 1; i < statement->length; i++) {
+				compile_expression(program, statement->content[i]);
+				emit(program, OPCODE_PRINT, false);
+			}
 
-						// generate the random number
-						// the maximum random number able to be generated by rand() is RAND_MAX and the minimum is 0
-						// so dividing it by RAND_MAX + 1.0 would return a number n such that 0 <= n < 1
-						float random_number = rand();
-						result->value_double = random_number / (RAND_MAX + 1.0);
+			// throw an error and exit the code
+			emit_failure(program, "user-defined error");
+			break;
 
-						// make a new Element containing the new random number and store it in the variable specified
-						set_variable(key, make(ELEMENT_NUMBER, result, heap), scopes, true);
-					}
+		case COMMAND_RAND:
+			if (statement->length != 2) {
+				emit_failure(program, "'rand' statement requires exactly 1 argument");
+				break;
+			}
 
-					if (!handled && String_is(command->value, "length") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'length' statement requires exactly 2 arguments");
-						}
+			emit(program, OPCODE_RAND, add_constant(program, statement->content[1]));
+			break;
 
-						Element *key = statement->content[1];
+		case COMMAND_LENGTH:
+			if (statement->length != 3) {
+				emit_failure(program, "'length' statement requires exactly 2 arguments");
+				break;
+			}
 
-						// evaluate the subject argument
-						Element *subject = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
-						if (subject->type != ELEMENT_STRING) {
-							whoops("'length' command requires the second argument to be a string");
-						}
+			compile_expression(program, statement->content[2]);
+			emit(program, OPCODE_EXPECT_STRING, add_constant(program, "'length' command requires the second argument to be a string"));
+			emit(program, OPCODE_LENGTH, add_constant(program, statement->content[1]));
+			break;
 
-						String *subject_string = subject->value;
+		case COMMAND_INPUT:
+			if (statement->length != 2) {
+				emit_failure(program, "'input' statement requires exactly 1 argument");
+				break;
+			}
 
-						Number *result = Number_new();
-						result->value_long = subject_string->length;
+			emit(program, OPCODE_INPUT, add_constant(program, statement->content[1]));
+			break;
 
-						// make a new Number Element for the result and assign it to the variable
-						set_variable(key, make(ELEMENT_NUMBER, result, heap), scopes, true);
-					}
+		case COMMAND_READFILE:
+			if (statement->length != 3) {
+				emit_failure(program, "'readfile' command requires exactly 2 arguments");
+				break;
+			}
 
-					if (!handled && String_is(command->value, "input") && (handled = true)) {
-						if (statement->length != 2) {
-							whoops("'input' statement requires exactly 1 argument");
-						}
+			compile_expression(program, statement->content[2]);
+			emit(program, OPCODE_EXPECT_STRING, add_constant(program, "'readfile' command requires the second argument to be a valid filepath string"));
+			emit(program, OPCODE_READFILE, add_constant(program, statement->content[1]));
+			break;
 
-						Element *key = statement->content[1];
+		case COMMAND_WRITEFILE:
+			if (statement->length != 4) {
+				emit_failure(program, "'writefile' command requires exactly 3 arguments");
+				break;
+			}
 
-						// make a temporary buffer to store the input
-						char *buffer = NULL;
-						size_t allocated_length = 0;
+			compile_expression(program, statement->content[2]);
+			emit(program, OPCODE_EXPECT_STRING, add_constant(program, "'writefile' command requires the first argument to be a string"));
+			compile_expression(program, statement->content[3]);
+			emit(program, OPCODE_EXPECT_STRING, add_constant(program, "'writefile' command requires the second argument to be a filepath string"));
+			emit(program, OPCODE_WRITEFILE, add_constant(program, statement->content[1]));
+			break;
 
-						// the actual length of the user input will be returned by getline, but we'll subtract one because we don't want the newline character at the end
-						size_t actual_length = getline(&buffer, &allocated_length, stdin) - 1;
+		case COMMAND_IF:
+			{
+				if (statement->length < 3) {
+					emit_failure(program, "'if' statement requires at least 2 arguments");
+					break;
+				}
 
-						String *result = String_new(actual_length);
+				// keep track of the jumps that skip to the end of the statement once an action has been performed
+				Stack *ends = Stack_new();
 
-						// move the useful data in the buffer to the result string
-						for (size_t i = 0; i < actual_length; i++) {
-							result->content[i] = buffer[i];
-						}
+				// iterate through each condition-action pair, skipping each action whose condition evaluates to a falsy value
+				// if there is a trailing value that does not belong to a pair, it is evaluated if no condition is acceptable
+				for (size_t i = 1; i < statement->length; i += 2) {
+					if (i + 1 == statement->length) {
+						compile_expression(program, statement->content[i]);
+						emit(program, OPCODE_POP, 0);
+					} else {
+						compile_expression(program, statement->content[i]);
+						size_t skip = emit(program, OPCODE_JUMP_IF_FALSE, 0);
 
-						// we no longer need the temporary buffer so it can be safely free'd
-						free(buffer);
+						compile_expression(program, statement->content[i + 1]);
+						emit(program, OPCODE_POP, 0);
+						ends = Stack_push(ends, (void*)(uintptr_t)emit(program, OPCODE_JUMP, 0));
 
-						// make a new String Element for the result and assign it to the variable
-						set_variable(key, make(ELEMENT_STRING, result, heap), scopes, true);
+						patch_jump(program, skip);
 					}
+				}
 
-					if (!handled && String_is(command->value, "readfile") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'readfile' command requires exactly 2 arguments");
-						}
+				for (size_t i = 0; i < ends->length; i++) {
+					patch_jump(program, (uintptr_t)ends->content[i]);
+				}
 
-						Element *key = statement->content[1];
+				free(ends);
+			};
+			break;
 
-						// evaluate the path argument
-						Element *path = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
-						if (path->type != ELEMENT_STRING) {
-							whoops("'readfile' command requires the second argument to be a valid filepath string");
-						}
+		case COMMAND_WHILE:
+			{
+				if (statement->length != 3) {
+					emit_failure(program, "'while' statement requires exactly 2 arguments");
+					break;
+				}
 
-						String *path_string = path->value;
+				// evaluate the condition and leave the loop once it evaluates to a falsy value
+				size_t start = program->length;
+				compile_expression(program, statement->content[1]);
+				size_t exit = emit(program, OPCODE_JUMP_IF_FALSE, 0);
 
-						// make a temporary char array to store the path so that it can be passed to read_file()
-						char path_buffer[path_string->length + 1];
+				// evaluate the action, then perform early garbage collection to avoid memory leaks within long loops
+				compile_expression(program, statement->content[2]);
+				emit(program, OPCODE_POP, 0);
+				emit(program, OPCODE_COLLECT, 0);
+				emit(program, OPCODE_LOOP, add_loop(program, start));
 
-						// copy the string contents to the temporary buffer
-						memcpy(&path_buffer, path_string->content, path_string->length);
+				patch_jump(program, exit);
+			};
+			break;
 
-						// add a null terminator to the path string
-						path_buffer[path_string->length] = '\0';
+		case COMMAND_LET:
+		case COMMAND_SET:
+			if (statement->length != 3) {
+				emit_failure(program, command == COMMAND_LET ? "'let' statement requires exactly 2 arguments" : "'set' statement requires exactly 2 arguments");
+				break;
+			}
 
-						// read the file
-						String *result_string = read_file(path_buffer);
+			compile_expression(program, statement->content[2]);
 
-						Element *result;
+			{
+				long address = resolve_variable(program, statement->content[1]);
 
-						// if the file contents can be read, make a String element and store them in it
-						// otherwise, the result will be a Null Element
-						if (result_string == NULL) {
-							result = make(ELEMENT_NULL, NULL, heap);
-						} else {
-							result = make(ELEMENT_STRING, result_string, heap);
-						}
+				// a 'let' statement can only use the Address of a variable in the innermost Scope
+				if (address >= 0 && (command == COMMAND_SET || ((Address*)program->addresses->content[address])->depth == 0)) {
+					emit(program, command == COMMAND_LET ? OPCODE_LET_LEXICAL : OPCODE_SET_LEXICAL, address);
+				} else {
+					emit(program, command == COMMAND_LET ? OPCODE_LET : OPCODE_SET, add_constant(program, statement->content[1]));
+				}
+			};
+			break;
 
-						set_variable(key, result, scopes, true);
-					}
+		case COMMAND_MUT:
+			if (statement->length != 4) {
+				emit_failure(program, "'mut' statement requires exactly 3 arguments");
+				break;
+			}
 
-					if (!handled && String_is(command->value, "writefile") && (handled = true)) {
-						if (statement->length != 4) {
-							whoops("'writefile' command requires exactly 3 arguments");
-						}
+			compile_expression(program, statement->content[1]);
+			emit(program, OPCODE_EXPECT_SCOPE, add_constant(program, "'mut' statement requires a scope object as the first argument"));
+			compile_expression(program, statement->content[2]);
+			compile_expression(program, statement->content[3]);
+			emit(program, OPCODE_MUT, 0);
+			break;
 
-						Element *key = statement->content[1];
+		case COMMAND_UNMAP:
+			if (statement->length != 3) {
+				emit_failure(program, "'unmap' statement requires exactly 2 arguments");
+				break;
+			}
 
-						// evaluate the new contents for the file
-						Element *new_contents = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
-						if (new_contents->type != ELEMENT_STRING) {
-							whoops("'writefile' command requires the first argument to be a string");
-						}
+			compile_expression(program, statement->content[1]);
+			emit(program, OPCODE_EXPECT_SCOPE, add_constant(program, "'unmap' statement requires a scope object as the first argument"));
+			compile_expression(program, statement->content[2]);
+			emit(program, OPCODE_UNMAP, 0);
+			break;
 
-						*keep_stack = Stack_push(*keep_stack, new_contents);
+		case COMMAND_EDIT:
+			if (statement->length != 4) {
+				emit_failure(program, "'edit' statement requires exactly 3 arguments");
+				break;
+			}
 
-						// evaluate the path argument
-						Element *path = evaluate(statement->content[3], ast_root, keep_stack, scopes_stack, heap);
-						if (path->type != ELEMENT_STRING) {
-							whoops("'writefile' command requires the second argument to be a filepath string");
-						}
+			// the property name is used as it is, without evaluation
+			compile_expression(program, statement->content[1]);
+			emit(program, OPCODE_EXPECT_SCOPE, add_constant(program, "'edit' statement requires a scope object as the first argument"));
+			compile_expression(program, statement->content[3]);
+			emit(program, OPCODE_EDIT, add_inline_cache(program, statement->content[2]));
+			break;
 
-						String *path_string = path->value;
+		case COMMAND_DELETE:
+			if (statement->length != 3) {
+				emit_failure(program, "'delete' statement requires exactly 2 arguments");
+				break;
+			}
 
-						// make a temporary char array to store the path so that it can be passed to read_file()
-						char path_buffer[path_string->length + 1];
+			compile_expression(program, statement->content[1]);
+			emit(program, OPCODE_EXPECT_SCOPE, add_constant(program, "'delete' statement requires a scope object as the first argument"));
+			emit(program, OPCODE_DELETE, add_constant(program, statement->content[2]));
+			break;
 
-						// copy the string contents to the temporary buffer
-						memcpy(&path_buffer, path_string->content, path_string->length);
+		case COMMAND_KEYS:
+		case COMMAND_VALUES:
+			{
+				bool keys = command == COMMAND_KEYS;
 
-						// add a null terminator to the path string
-						path_buffer[path_string->length] = '\0';
+				if (statement->length != 3) {
+					emit_failure(program, keys ? "'keys' statement requires exactly 2 arguments" : "'values' statement requires exactly 2 arguments");
+					break;
+				}
 
-						// create a new Number to represent the result
-						Number *result = Number_new();
+				compile_expression(program, statement->content[1]);
+				emit(program, OPCODE_EXPECT_SCOPE, add_constant(program, keys ? "'keys' statement only accepts a scope as the first argument" : "'values' statement only accepts a scope as the first argument"));
+				compile_expression(program, statement->content[2]);
+				emit(program, OPCODE_EXPECT_CLOSURE, add_constant(program, keys ? "'keys' statement only accepts a closure as its second argument" : "'values' statement only accepts a closure as its second argument"));
+				emit(program, keys ? OPCODE_KEYS : OPCODE_VALUES, 0);
+			};
+			break;
+	}
+}
 
-						// attempt to write the new contents to the file and update the result number's value accordingly
-						result->value_long = write_file(path_buffer, new_contents->value) ? 1 : 0;
+// function to compile a sequence into instructions that leave either its own scope or its returned value on top of the value stack
+void compile_sequence(Program *program, Element *branch) {
+	Stack *sequence = branch->value;
+
+	// keep track of the jumps made by 'return' statements so they can be pointed to the end of the sequence
+	Stack *returns = Stack_new();
+
+	// find every key that the statements of the sequence define in its local scope, in the order that they will be added to it
+	Stack *names = Stack_new();
+	for (size_t i = 0; i < sequence->length; i++) {
+		Stack *statement = sequence->content[i];
+
+		switch ((CommandType)(uintptr_t)((Element*)statement->content[0])->value) {
+			case COMMAND_LET:
+			case COMMAND_RAND:
+			case COMMAND_LENGTH:
+			case COMMAND_INPUT:
+			case COMMAND_READFILE:
+			case COMMAND_WRITEFILE:
+				{
+					if (statement->length < 2 || ((Element*)statement->content[1])->type == ELEMENT_NULL) {
+						break;
+					}
 
-						*keep_stack = Stack_pop(*keep_stack);
+					// keys that are defined more than once keep their first position
+					bool found = false;
+					for (size_t j = 0; j < names->length && !found; j++) {
+						found = compare_elements(names->content[j], statement->content[1]);
+					}
 
-						// update the variable to reflect the writing operation's verdict by setting it to a new Number Element representing said verdict
-						set_variable(key, make(ELEMENT_NUMBER, result, heap), scopes, true);
+					if (!found) {
+						names = Stack_push(names, statement->content[1]);
 					}
+				};
+				break;
 
-					if (!handled && String_is(command->value, "if") && (handled = true)) {
-						if (statement->length < 3) {
-							whoops("'if' statement requires at least 2 arguments");
-						}
+			default:
+				break;
+		}
+	}
 
-						bool result = false;
+	// each sequence should have its own local scope
+	emit(program, OPCODE_ENTER_SEQUENCE, 0);
+	enter_static_scope(program, names);
 
-						// iterate through each condition-action pair and perform only the first action that is associated with a condition that evaluates to a truthy value
-						// if there is a trailing value that does not belong to a pair, execute it if no condition is acceptable
-						for (size_t i = 1; i < statement->length && !result; i += 2) {
-							if (i + 1 == statement->length) {
-								// if this is the last argument, evaluate it as an action, since no condition was acceptable
-								evaluate(statement->content[i], ast_root, keep_stack, scopes_stack, heap);
-							} else if (value_is_truthy(evaluate(statement->content[i], ast_root, keep_stack, scopes_stack, heap))) {
-								// if there is a condition and it evaluates to a truthy value, evaluate it and cease further evaluations
+	for (size_t i = 0; i < sequence->length; i++) {
+		compile_statement(program, sequence->content[i], &returns);
 
-								result = true;
-								evaluate(statement->content[i + 1], ast_root, keep_stack, scopes_stack, heap);
-							}
-						}
-					}
+		// collect any garbage that may have accumulated over the course of the execution of this statement
+		emit(program, OPCODE_COLLECT, 0);
+	}
 
-					if (!handled && String_is(command->value, "while") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'while' statement requires exactly 2 arguments");
-						}
+	// if no value was returned by the sequence, it evaluates to its own scope
+	emit(program, OPCODE_LEAVE_SEQUENCE, 0);
+	program->scope = program->scope->parent;
 
-						// evaluate the condition and check if it's a truthy value before iterating
-						while (value_is_truthy(evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap))) {
-							// evaluate the action
-							evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
+	for (size_t i = 0; i < returns->length; i++) {
+		patch_jump(program, (uintptr_t)returns->content[i]);
+	}
 
-							// perform early garbage collection to avoid memory leaks within long loops
-							garbage_collect(NULL, ast_root, keep_stack, scopes_stack, heap);
-						}
-					}
+	free(returns);
+}
 
-					if (!handled && String_is(command->value, "let") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'let' statement requires exactly 2 arguments");
-						}
+// function to mark the applications in a Program whose result is returned straight away as tail calls, so that calls to compiled Closures can reuse the current call
+// the result of an application is returned straight away if nothing but leaving Sequences and jumping happens between the application and the end of the Closure
+void mark_tail_calls(Program *program) {
+	Instruction *code = program->code;
+
+	for (size_t i = 0; i < program->length; i++) {
+		if (code[i].opcode != OPCODE_APPLY) {
+			continue;
+		}
 
-						Element *key = statement->content[1];
+		// follow the instructions that run after the application until one of them does something else
+		// jumps made by 'return' statements always go forwards, so this always stops
+		size_t next = i + 1;
+		while (code[next].opcode == OPCODE_EXIT_SEQUENCE || (code[next].opcode == OPCODE_JUMP && code[next].operand > next)) {
+			next = code[next].opcode == OPCODE_JUMP ? code[next].operand : next + 1;
+		}
 
-						// evaluate the second argument to find the value to which the variable should be assigned
-						Element *value = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
+		if (code[next].opcode == OPCODE_RETURN) {
+			code[i].opcode = OPCODE_TAIL_APPLY;
+		}
+	}
+}
 
-						// update the relevant scope with the new mapping
-						set_variable(key, value, scopes, true);
-					}
+// function to replace common sequences of instructions in a Program with superinstructions
+// the rest of each sequence is left where it was, so jumps to any of its instructions still work as they did before
+void fuse_superinstructions(Program *program) {
+	Instruction *code = program->code;
+
+	for (size_t i = 0; i < program->length; i++) {
+		size_t remaining = program->length - i;
+
+		if (remaining >= 4 && code[i].opcode == OPCODE_GET_LEXICAL && code[i + 1].opcode == OPCODE_CONSTANT && code[i + 2].opcode == OPCODE_OPERATE && (code[i + 3].opcode == OPCODE_SET_LEXICAL || code[i + 3].opcode == OPCODE_LET_LEXICAL)) {
+			// statements like 'set x (x + 1)', which update a variable using its own value and a constant
+			code[i].opcode = OPCODE_UPDATE_LEXICAL;
+		} else if (remaining >= 2 && code[i].opcode == OPCODE_GET_LEXICAL && code[i + 1].opcode == OPCODE_APPLY) {
+			// applications like 'a y', which are mostly used to index into Scopes such as in 'mut (a y) x v'
+			code[i].opcode = OPCODE_APPLY_LEXICAL;
+		} else if (remaining >= 2 && code[i].opcode == OPCODE_OPERATE && code[i + 1].opcode == OPCODE_JUMP_IF_FALSE) {
+			// conditions like 'while (x < n)', which branch on the result of an operation straight away
+			code[i].opcode = OPCODE_OPERATE_JUMP_IF_FALSE;
+		}
+	}
+}
 
-					if (!handled && String_is(command->value, "set") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'set' statement requires exactly 2 arguments");
-						}
+// function to compile an entire abstract syntax tree into a Program
+Program *compile_program(Element *ast_root) {
+	Program *program = Program_new();
 
-						Element *key = statement->content[1];
+	// compile the main sequence, discard its evaluation and stop
+	compile_expression(program, ast_root);
+	emit(program, OPCODE_POP, 0);
+	emit(program, OPCODE_HALT, 0);
 
-						// evaluate the second argument to find the value to which the variable should be assigned
-						Element *value = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
+	// compile the body of every Closure expression found along the way
+	// compiling one body may find more Closure expressions, which are added to the end of the list and compiled in turn
+	for (size_t i = 0; i < program->prototypes->length; i++) {
+		Prototype *prototype = program->prototypes->content[i];
 
-						// update the relevant scope with the new mapping
-						set_variable(key, value, scopes, false);
-					}
+		prototype->entry = program->length;
 
-					if (!handled && String_is(command->value, "mut") && (handled = true)) {
-						if (statement->length != 4) {
-							whoops("'mut' statement requires exactly 3 arguments");
-						}
+		// the body is compiled in the Scope that the Closure was made in, inside a Scope for its variable if it has one
+		program->scope = prototype->scope;
+		if (prototype->variable != NULL) {
+			Stack *names = Stack_new();
+			names = Stack_push(names, prototype->variable);
+			enter_static_scope(program, names);
+		}
 
-						// evaluate the first argument to find the subject
-						Element *subject = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
+		compile_expression(program, prototype->expression);
+		emit(program, OPCODE_RETURN, 0);
+	}
 
-						if (subject->type != ELEMENT_SCOPE) {
-							whoops("'mut' statement requires a scope object as the first argument");
-						}
+	mark_tail_calls(program);
+	fuse_superinstructions(program);
 
-						// evaluate the second argument to find the key
-						Element *key = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
+	return program;
+}
 
-						*keep_stack = Stack_push(*keep_stack, key);
+// array storing the name of each opcode, in the same order as the Opcode enumeration, so that instructions can be written out as C
+char *const OPCODE_NAMES[] = {"OPCODE_CONSTANT", "OPCODE_GET_VARIABLE", "OPCODE_GET_LEXICAL", "OPCODE_POP", "OPCODE_ENTER_SEQUENCE", "OPCODE_LEAVE_SEQUENCE", "OPCODE_EXIT_SEQUENCE", "OPCODE_JUMP", "OPCODE_JUMP_IF_FALSE", "OPCODE_LOOP", "OPCODE_AND", "OPCODE_OR", "OPCODE_OPERATE", "OPCODE_APPLY", "OPCODE_TAIL_APPLY", "OPCODE_ACCESS", "OPCODE_CLOSURE", "OPCODE_RETURN", "OPCODE_PRINT", "OPCODE_RAND", "OPCODE_LENGTH", "OPCODE_INPUT", "OPCODE_READFILE", "OPCODE_WRITEFILE", "OPCODE_LET", "OPCODE_SET", "OPCODE_LET_LEXICAL", "OPCODE_SET_LEXICAL", "OPCODE_MUT", "OPCODE_UNMAP", "OPCODE_EDIT", "OPCODE_DELETE", "OPCODE_KEYS", "OPCODE_VALUES", "OPCODE_EXPECT_SCOPE", "OPCODE_EXPECT_STRING", "OPCODE_EXPECT_CLOSURE", "OPCODE_COLLECT", "OPCODE_FAIL", "OPCODE_HALT", "OPCODE_UPDATE_LEXICAL", "OPCODE_APPLY_LEXICAL", "OPCODE_OPERATE_JUMP_IF_FALSE", "OPCODE_OPERATE_INTEGER", "OPCODE_OPERATE_DOUBLE", "OPCODE_UPDATE_LEXICAL_INTEGER", "OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE", "OPCODE_NATIVE_LOOP"};
 
-						// evaluate the third argument to find the value
-						Element *value = evaluate(statement->content[3], ast_root, keep_stack, scopes_stack, heap);
+// array storing the name of the runtime function that does the work of each opcode, in the same order as the Opcode enumeration, or NULL for opcodes that are written out as C in some other way
+char *const OPCODE_FUNCTIONS[] = {NULL, "do_get_variable", "do_get_lexical", NULL, "do_enter_sequence", "do_leave_sequence", "do_exit_sequence", NULL, NULL, NULL, NULL, NULL, "do_operate", NULL, NULL, "do_access", "do_closure", NULL, "do_print", "do_rand", "do_length", "do_input", "do_readfile", "do_writefile", "do_set_variable", "do_set_variable", "do_set_lexical", "do_set_lexical", "do_mut", "do_unmap", "do_edit", "do_delete", "do_iterate", "do_iterate", "do_expect", "do_expect", "do_expect", "do_collect", "do_fail", NULL, NULL, NULL, NULL, "do_operate", "do_operate", NULL, NULL, NULL};
 
-						// update the Scope with the new mapping
-						subject->value = set_scope_mapping(subject->value, key, value);
+// function to write some characters to a C file as a string literal
+void write_c_string(FILE *file, unsigned char *content, size_t length) {
+	fputc('"', file);
 
-						*keep_stack = Stack_pop(*keep_stack);
-					}
+	for (size_t i = 0; i < length; i++) {
+		unsigned char c = content[i];
 
-					if (!handled && String_is(command->value, "unmap") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'unmap' statement requires exactly 2 arguments");
-						}
+		// anything that isn't plainly printable is written as an octal escape sequence, which always has three digits so that it can't run into a digit after it
+		if (c == '"' || c == '\\' || c == '?') {
+			fprintf(file, "\\%c", c);
+		} else if (c < ' ' || c > '~') {
+			fprintf(file, "\\%03o", c);
+		} else {
+			fputc(c, file);
+		}
+	}
 
-						// evaluate the first argument to find the subject
-						Element *subject = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
-						if (subject->type != ELEMENT_SCOPE) {
-							whoops("'unmap' statement requires a scope object as the first argument");
-						}
+	fputc('"', file);
+}
 
-						// evaluate the second argument to find the key
-						Element *key = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
+// function to find the position of an Element in the list of Elements that a compiled Program uses, adding it to the list if it isn't there yet
+// the Elements that an Element contains are added before it so that the Elements can be made in order, and each Element is only added once so that Elements that are compared by identity stay identical
+size_t find_program_element(Stack **elements, Element *element) {
+	for (size_t i = 0; i < (*elements)->length; i++) {
+		if ((*elements)->content[i] == element) {
+			return i;
+		}
+	}
 
-						// delete the appropriate mapping from the Scope
-						subject->value = delete_scope_mapping(subject->value, key);
-					}
+	switch (element->type) {
+		case ELEMENT_OPERATION:
+			{
+				Operation *operation = element->value;
 
-					if (!handled && String_is(command->value, "edit") && (handled = true)) {
-						if (statement->length != 4) {
-							whoops("'edit' statement requires exactly 3 arguments");
-						}
+				if (operation->element_a != NULL) {
+					find_program_element(elements, operation->element_a);
+				}
 
-						// evaluate the first argument to find the subject
-						Element *subject = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
-						if (subject->type != ELEMENT_SCOPE) {
-							whoops("'edit' statement requires a scope object as the first argument");
-						}
+				if (operation->element_b != NULL) {
+					find_program_element(elements, operation->element_b);
+				}
+			};
+			break;
 
-						Element *property_name = statement->content[2];
+		case ELEMENT_SEQUENCE:
+			{
+				Stack *sequence = element->value;
 
-						// evaluate the third argument to find the value
-						Element *value = evaluate(statement->content[3], ast_root, keep_stack, scopes_stack, heap);
+				for (size_t y = 0; y < sequence->length; y++) {
+					Stack *statement = sequence->content[y];
 
-						// update the Scope with the new mapping
-						subject->value = set_scope_mapping(subject->value, property_name, value);
+					for (size_t x = 0; x < statement->length; x++) {
+						find_program_element(elements, statement->content[x]);
 					}
+				}
+			};
+			break;
+	}
 
-					if (!handled && String_is(command->value, "delete") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'delete' statement requires exactly 2 arguments");
-						}
-
-						// evaluate the first argument to find the subject
-						Element *subject = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
-						if (subject->type != ELEMENT_SCOPE) {
-							whoops("'delete' statement requires a scope object as the first argument");
-						}
+	*elements = Stack_push(*elements, element);
+	return (*elements)->length - 1;
+}
 
-						// evaluate the second argument to find the key
-						Element *property_name = statement->content[2];
+// function to write out the C code that makes one of the Elements that a compiled Program uses
+void write_program_element(FILE *file, Stack **elements, size_t index) {
+	Element *element = (*elements)->content[index];
 
-						// delete the appropriate mapping from the Scope
-						subject->value = delete_scope_mapping(subject->value, property_name);
-					}
+	switch (element->type) {
+		case ELEMENT_NULL:
+			fprintf(file, "\tprogram_elements[%zu] = make(ELEMENT_NULL, NULL, heap);\n", index);
+			break;
 
-					if (!handled && String_is(command->value, "keys") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'keys' statement requires exactly 2 arguments");
-						}
+		case ELEMENT_VARIABLE:
+		case ELEMENT_STRING:
+			{
+				String *string = element->value;
 
-						// evaluate the first operand and reject it if it is not a Scope
-						Element *subject = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
-						if (subject->type != ELEMENT_SCOPE) {
-							whoops("'keys' statement only accepts a scope as the first argument");
-						}
+				fprintf(file, "\tprogram_elements[%zu] = make(%s, String_from((unsigned char *)", index, element->type == ELEMENT_VARIABLE ? "ELEMENT_VARIABLE" : "ELEMENT_STRING");
+				write_c_string(file, string->content, string->length);
+				fprintf(file, ", %zu), heap);\n", string->length);
+			};
+			break;
 
-						*keep_stack = Stack_push(*keep_stack, subject);
+		case ELEMENT_NUMBER:
+			{
+				Number *number = element->value;
 
-						// evaluate the second operand and reject it if it is not a Closure
-						Element *closure = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
-						if (closure->type != ELEMENT_CLOSURE) {
-							whoops("'keys' statement only accepts a closure as its second argument");
-						}
+				fprintf(file, "\tprogram_elements[%zu] = make_number((Number){", index);
 
-						Scope *scope = subject->value;
+				// floating-point values are written in hexadecimal so that they are read back exactly
+				if (!number->is_double) {
+					fprintf(file, "false, {.value_long = %ldL}", number->value_long);
+				} else if (isnan(number->value_double)) {
+					fputs("true, {.value_double = NAN}", file);
+				} else if (isinf(number->value_double)) {
+					fprintf(file, "true, {.value_double = %sINFINITY}", number->value_double < 0 ? "-" : "");
+				} else {
+					fprintf(file, "true, {.value_double = %a}", number->value_double);
+				}
 
-						// iterate through each mapping in the Scope
-						for (size_t i = 0; i < scope->length; i++) {
-							// retrieve the key of this mapping
-							Element *key = scope->maps[i].key;
+				fputs("}, heap);\n", file);
+			};
+			break;
 
-							// if the key is not a property name, apply it to the function by virtually juxtaposing the two
-							if (key->type != ELEMENT_VARIABLE) {
-								juxtapose(closure, key, ast_root, keep_stack, scopes_stack, heap);
-							}
-						}
+		case ELEMENT_COMMAND:
+			fprintf(file, "\tprogram_elements[%zu] = make(ELEMENT_COMMAND, (void*)(uintptr_t)%zu, heap);\n", index, (size_t)(uintptr_t)element->value);
+			break;
 
-						*keep_stack = Stack_pop(*keep_stack);
-					}
+		case ELEMENT_OPERATION:
+			{
+				Operation *operation = element->value;
 
-					if (!handled && String_is(command->value, "values") && (handled = true)) {
-						if (statement->length != 3) {
-							whoops("'values' statement requires exactly 2 arguments");
-						}
+				fprintf(file, "\tprogram_elements[%zu] = make(ELEMENT_OPERATION, Operation_new(%d, ", index, operation->type);
 
-						// evaluate the first operand and reject it if it is not a Scope
-						Element *subject = evaluate(statement->content[1], ast_root, keep_stack, scopes_stack, heap);
-						if (subject->type != ELEMENT_SCOPE) {
-							whoops("'values' statement only accepts a scope as the first argument");
-						}
+				if (operation->element_a == NULL) {
+					fputs("NULL, ", file);
+				} else {
+					fprintf(file, "program_elements[%zu], ", find_program_element(elements, operation->element_a));
+				}
 
-						*keep_stack = Stack_push(*keep_stack, subject);
+				if (operation->element_b == NULL) {
+					fputs("NULL", file);
+				} else {
+					fprintf(file, "program_elements[%zu]", find_program_element(elements, operation->element_b));
+				}
 
-						// evaluate the second operand and reject it if it is not a Closure
-						Element *closure = evaluate(statement->content[2], ast_root, keep_stack, scopes_stack, heap);
-						if (closure->type != ELEMENT_CLOSURE) {
-							whoops("'values' statement only accepts a closure as its second argument");
-						}
+				fputs("), heap);\n", file);
+			};
+			break;
 
-						Scope *scope = subject->value;
+		case ELEMENT_SEQUENCE:
+			{
+				Stack *sequence = element->value;
 
-						// iterate through each mapping in the Scope
-						for (size_t i = 0; i < scope->length; i++) {
-							// retrieve the key of this mapping
-							Element *key = scope->maps[i].value;
+				fputs("\t{\n\t\tStack *sequence = Stack_new();\n\t\tStack *statement;\n", file);
 
-							// if the key is not a property name, apply it to the function by virtually juxtaposing the two
-							if (key->type != ELEMENT_VARIABLE) {
-								juxtapose(closure, key, ast_root, keep_stack, scopes_stack, heap);
-							}
-						}
+				for (size_t y = 0; y < sequence->length; y++) {
+					Stack *statement = sequence->content[y];
 
-						*keep_stack = Stack_pop(*keep_stack);
-					}
+					fputs("\t\tstatement = Stack_new();\n", file);
 
-					// if no matching command was found for this statement, it must be an invalid command
-					if (!handled) {
-						// print the invalid command, then throw an error about it
-						putchar('\n');
-						String_print(command->value);
-						whoops("command not recognised");
+					for (size_t x = 0; x < statement->length; x++) {
+						fprintf(file, "\t\tstatement = Stack_push(statement, program_elements[%zu]);\n", find_program_element(elements, statement->content[x]));
 					}
 
-					// collect any garbage that may have accumulated over the course of the execution of this statement
-					garbage_collect(NULL, ast_root, keep_stack, scopes_stack, heap);
+					fputs("\t\tsequence = Stack_push(sequence, statement);\n", file);
 				}
 
-				// remove the current Sequence's Scope object from the Scope stack
-				scopes->value = Stack_pop(scopes->value);
-
-				// if no value was returned by the sequence, return its own scope
-				return scope;
+				fprintf(file, "\t\tprogram_elements[%zu] = make(ELEMENT_SEQUENCE, sequence, heap);\n\t}\n", index);
 			};
 			break;
 
-		case ELEMENT_VARIABLE:
-			// if it's a variable name, return its value
-			return get_variable(branch, scopes);
-
-		case ELEMENT_OPERATION:
-			// handle the behaviours of each operation
-			{
-				Operation *operation = branch->value;
+		default:
+			whoops("cannot compile this kind of value to C.");
+	}
+}
 
-				if (operation->element_a == NULL || operation->element_b == NULL) {
-					whoops("misplaced operator (maybe you need to put some brackets around one of your expressions?)");
-				}
+// function to write out a compiled Program as C source code that runs it without the interpreter
+// every instruction becomes a call to the runtime function that does its work, and jumps become gotos, so there is no instruction dispatch except when a Closure is called or returns
+// the code links against the runtime library, which the Program is rebuilt with when the code starts
+void write_program_as_c(Program *program, char *script_path, FILE *file) {
+	Instruction *code = program->code;
+
+	// work out which constants are error messages rather than Elements from the instructions that use them
+	bool *is_message = calloc(program->constants->length + 1, sizeof(bool));
+	for (size_t i = 0; i < program->length; i++) {
+		switch (code[i].opcode) {
+			case OPCODE_EXPECT_SCOPE:
+			case OPCODE_EXPECT_STRING:
+			case OPCODE_EXPECT_CLOSURE:
+			case OPCODE_FAIL:
+				is_message[code[i].operand] = true;
+				break;
+		}
+	}
 
-				switch (operation->type) {
-					case OPERATION_JUXTAPOSITION:
-						{
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
+	// gather every Element that the Program uses, remembering where each constant ended up
+	Stack *elements = Stack_new();
+	size_t *constant_elements = calloc(program->constants->length + 1, sizeof(size_t));
+	for (size_t i = 0; i < program->constants->length; i++) {
+		if (!is_message[i]) {
+			constant_elements[i] = find_program_element(&elements, program->constants->content[i]);
+		}
+	}
+	for (size_t i = 0; i < program->addresses->length; i++) {
+		find_program_element(&elements, ((Address*)program->addresses->content[i])->name);
+	}
+	for (size_t i = 0; i < program->caches->length; i++) {
+		find_program_element(&elements, ((InlineCache*)program->caches->content[i])->name);
+	}
+	for (size_t i = 0; i < program->prototypes->length; i++) {
+		Prototype *prototype = program->prototypes->content[i];
 
-							return juxtapose(element_a, element_b, ast_root, keep_stack, scopes_stack, heap);
-						};
-						break;
+		if (prototype->variable != NULL) {
+			find_program_element(&elements, prototype->variable);
+		}
+	}
 
-					case OPERATION_EQUALITY:
-					case OPERATION_INEQUALITY:
-						{
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
+	// work out which instructions can be jumped to, and which of them can also be continued from when the code is entered, which are the start of the Program, the start of each Closure and the instruction after each call
+	bool *is_target = calloc(program->length + 1, sizeof(bool));
+	bool *is_entry = calloc(program->length + 1, sizeof(bool));
+	bool has_calls = false;
+	is_entry[0] = true;
+	for (size_t i = 0; i < program->prototypes->length; i++) {
+		is_entry[((Prototype*)program->prototypes->content[i])->entry] = true;
+	}
+	for (size_t i = 0; i < program->length; i++) {
+		switch (code[i].opcode) {
+			case OPCODE_JUMP:
+			case OPCODE_JUMP_IF_FALSE:
+			case OPCODE_AND:
+			case OPCODE_OR:
+				is_target[code[i].operand] = true;
+				break;
+
+			case OPCODE_LOOP:
+				is_target[((Loop*)program->loops->content[code[i].operand])->start] = true;
+				break;
+
+			case OPCODE_OPERATE_JUMP_IF_FALSE:
+				is_target[code[i + 1].operand] = true;
+				is_target[i + 2] = true;
+				break;
+
+			case OPCODE_UPDATE_LEXICAL:
+				is_target[i + 4] = true;
+				break;
+
+			case OPCODE_APPLY:
+				is_entry[i + 1] = true;
+				has_calls = true;
+				break;
+
+			case OPCODE_TAIL_APPLY:
+			case OPCODE_RETURN:
+				has_calls = true;
+				break;
+
+			case OPCODE_APPLY_LEXICAL:
+				is_entry[i + 2] = true;
+				is_target[i + 2] = true;
+				has_calls = true;
+				break;
+		}
+	}
+	for (size_t i = 0; i < program->length; i++) {
+		is_target[i] = is_target[i] || is_entry[i];
+	}
 
-							// create a new number for the result
-							Number *number = Number_new();
+	fputs("// ", file);
+	fputs(script_path, file);
+	fputs(", compiled to C by ash-script\n", file);
+	fputs("// build it against the runtime library, e.g. with: gcc -O2 -I modules/Runtime/ -I modules/Stack/ -I modules/String/ -I modules/Pool/ -o script script.c build/libash-script.a -lm\n\n", file);
+	fputs("#include <stdlib.h>\n#include <stdio.h>\n#include <stdbool.h>\n#include <stdint.h>\n#include <math.h>\n#include <unistd.h>\n\n#include \"Runtime.h\"\n\n", file);
 
-							// check if the two elements are equal or not
-							bool result = compare_elements(element_a, element_b);
+	// the instructions are kept so that the runtime functions can read their operands and quicken them
+	fputs("// the instructions of the Program that this code was compiled from\nInstruction program_code[] = {\n", file);
+	for (size_t i = 0; i < program->length; i++) {
+		fprintf(file, "\t{%s, %u},\n", OPCODE_NAMES[code[i].opcode], code[i].operand);
+	}
+	fputs("};\n\n", file);
 
-							// if we are checking for inequality, invert the result
-							if (operation->type == OPERATION_INEQUALITY) {
-								result = !result;
-							}
+	fprintf(file, "// the Elements that the Program uses as constants and names\nElement *program_elements[%zu];\n\n", elements->length + 1);
 
-							// set the number value to either 1 (true) or 0 (false) depending on the result
-							number->value_long = result ? 1 : 0;
+	fputs("// function to rebuild the Program that this code was compiled from, making its Elements on a certain heap\nProgram *load_program(Heap *heap) {\n", file);
+	for (size_t i = 0; i < elements->length; i++) {
+		write_program_element(file, &elements, i);
+	}
 
-							// make a new Number Element containing the new number
-							return make(ELEMENT_NUMBER, number, heap);
-						};
-						break;
+	fputs("\n\tProgram *program = Program_new();\n\n\tfor (size_t i = 0; i < sizeof(program_code) / sizeof(program_code[0]); i++) {\n\t\temit(program, program_code[i].opcode, program_code[i].operand);\n\t}\n\n", file);
+	for (size_t i = 0; i < program->constants->length; i++) {
+		if (is_message[i]) {
+			fputs("\tadd_constant(program, ", file);
+			write_c_string(file, program->constants->content[i], strlen(program->constants->content[i]));
+			fputs(");\n", file);
+		} else {
+			fprintf(file, "\tadd_constant(program, program_elements[%zu]);\n", constant_elements[i]);
+		}
+	}
+	for (size_t i = 0; i < program->addresses->length; i++) {
+		Address *address = program->addresses->content[i];
+		fprintf(file, "\tadd_address(program, program_elements[%zu], %zu, %zu);\n", find_program_element(&elements, address->name), address->depth, address->slot);
+	}
+	for (size_t i = 0; i < program->caches->length; i++) {
+		fprintf(file, "\tadd_inline_cache(program, program_elements[%zu]);\n", find_program_element(&elements, ((InlineCache*)program->caches->content[i])->name));
+	}
+	for (size_t i = 0; i < program->prototypes->length; i++) {
+		Prototype *prototype = program->prototypes->content[i];
 
-					case OPERATION_ADDITION:
-					case OPERATION_SUBTRACTION:
-					case OPERATION_MULTIPLICATION:
-					case OPERATION_DIVISION:
-					case OPERATION_REMAINDER:
-					case OPERATION_POW:
-					case OPERATION_LT:
-					case OPERATION_GT:
-					case OPERATION_LTE:
-					case OPERATION_GTE:
-						{
-							if (operation->element_a == NULL || operation->element_b == NULL) {
-								whoops("too many operations");
-							}
-
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
-
-							// throw an error if either one is not a number
-							if (element_a->type != ELEMENT_NUMBER || element_b->type != ELEMENT_NUMBER) {
-								whoops("numeric operations can only be applied to numeric values");
-							}
-
-							// operate on the numbers and return a new Number Element containing the result
-							return make(ELEMENT_NUMBER, perform_numeric_operation(operation->type, element_a->value, element_b->value), heap);
-						};
-						break;
+		// the syntax tree of a Closure is only needed when walking the tree, so it is left out
+		if (prototype->variable == NULL) {
+			fprintf(file, "\tadd_prototype(program, NULL, NULL, %zu);\n", prototype->entry);
+		} else {
+			fprintf(file, "\tadd_prototype(program, NULL, program_elements[%zu], %zu);\n", find_program_element(&elements, prototype->variable), prototype->entry);
+		}
+	}
+	fputs("\n\treturn program;\n}\n\n", file);
 
-					case OPERATION_SHIFT_LEFT:
-					case OPERATION_SHIFT_RIGHT:
-					case OPERATION_BWAND:
-					case OPERATION_BWOR:
-					case OPERATION_BWXOR:
-						{
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
-
-							if (element_a->type != ELEMENT_NUMBER || element_b->type != ELEMENT_NUMBER) {
-								whoops("bitwise operations may only be applied to integers");
-							}
-
-							Number *number_a = element_a->value;
-							Number *number_b = element_b->value;
-
-							if (number_a->is_double || number_b->is_double) {
-								whoops("bitwise operations may only be applied to integers");
-							}
-
-							// make a new number to store the result
-							Number *result = Number_new();
-
-							// perform the appropriate bitwise operation
-							switch (operation->type) {
-								case OPERATION_SHIFT_LEFT:
-									result->value_long = number_a->value_long << number_b->value_long;
-									break;
-								case OPERATION_SHIFT_RIGHT:
-									result->value_long = number_a->value_long >> number_b->value_long;
-									break;
-								case OPERATION_BWAND:
-									result->value_long = number_a->value_long & number_b->value_long;
-									break;
-								case OPERATION_BWOR:
-									result->value_long = number_a->value_long | number_b->value_long;
-									break;
-								case OPERATION_BWXOR:
-									result->value_long = number_a->value_long ^ number_b->value_long;
-									break;
-							}
-
-							// make a new Element to store the result and return it
-							return make(ELEMENT_NUMBER, result, heap);
-						};
-						break;
+	fputs("// function to run the instructions of the Program from a certain instruction until it halts or the call that it was started in returns\nElement *run_compiled(VM *vm, Instruction *ip) {\n\tInstruction *code = vm->program->code;\n\n", file);
 
-					case OPERATION_SUBL:
-					case OPERATION_SUBG:
-						{
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
-
-							// make sure that the types line up for this operation
-							if (element_a->type != ELEMENT_STRING || element_b->type != ELEMENT_NUMBER) {
-								whoops("substring operations must be applied to a string and a non-negative integer");
-							}
-
-							String *string = element_a->value;
-							Number *slice_index = element_b->value;
-
-							// ensure that the number supplied is not a negative number or a floating-point value, since these kinds of values are not easily applicable to string slicing
-							if (slice_index->is_double || slice_index->value_long < 0) {
-								whoops("substring operations must be applied to a string and a non-negative integer");
-							}
-
-							// figure out the length of the new string
-							// for SUBL, this will either be the length of the string or the slice index, whichever is smaller
-							// for SUBG, this will either be the subtraction of the slice index from the length or zero if the slice index is bigger than the length
-							size_t length;
-							if (operation->type == OPERATION_SUBL) {
-								if (slice_index->value_long >= string->length) {
-									length = string->length;
-								} else {
-									length = slice_index->value_long;
-								}
-							} else {
-								if (slice_index->value_long >= string->length) {
-									length = 0;
-								} else {
-									length = string->length - slice_index->value_long;
-								}
-							}
-
-							String *result = String_new(length);
-
-							// iterate through the characters of the new string and update them to match the relevant characters in the old string
-							for (size_t i = 0; i < length; i++) {
-								if (operation->type == OPERATION_SUBL) {
-									result->content[i] = string->content[i];
-								} else {
-									result->content[i] = string->content[i + slice_index->value_long];
-								}
-							}
-
-							// make a new Element to store the result and return it
-							return make(ELEMENT_STRING, result, heap);
-						};
-						break;
+	// calls and returns continue from an instruction that is only known while running, so they go through a table of every instruction that can be continued from
+	fputs(has_calls ? "\tdispatch:\n\tswitch (ip - code) {\n" : "\tswitch (ip - code) {\n", file);
+	for (size_t i = 0; i < program->length; i++) {
+		if (is_entry[i]) {
+			fprintf(file, "\t\tcase %zu: goto instruction_%zu;\n", i, i);
+		}
+	}
+	fputs("\t\tdefault: whoops(\"cannot continue running from this instruction.\");\n\t}\n", file);
 
-					case OPERATION_CHAR_AT:
-						{
-							Element *subject = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, subject);
-							Element *index = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
+	for (size_t i = 0; i < program->length; i++) {
+		Instruction *instruction = code + i;
 
-							// both Elements must be of an acceptable type
-							if (subject->type != ELEMENT_STRING || index->type != ELEMENT_NUMBER) {
-								whoops("character value operator must be applied to a string and an integer, in that order");
-							}
+		if (is_target[i]) {
+			fprintf(file, "\n\tinstruction_%zu:\n", i);
+		}
 
-							Number *index_number = index->value;
+		switch (instruction->opcode) {
+			case OPCODE_CONSTANT:
+				fprintf(file, "\tpush_value(vm, program_elements[%zu]);\n", constant_elements[instruction->operand]);
+				break;
+
+			case OPCODE_POP:
+				fputs("\tpop_value(vm);\n", file);
+				break;
+
+			case OPCODE_JUMP:
+				fprintf(file, "\tgoto instruction_%u;\n", instruction->operand);
+				break;
+
+			case OPCODE_LOOP:
+				fprintf(file, "\tgoto instruction_%zu;\n", ((Loop*)program->loops->content[instruction->operand])->start);
+				break;
+
+			case OPCODE_JUMP_IF_FALSE:
+				fprintf(file, "\tif (do_jump_if_false(vm, &code[%zu])) goto instruction_%u;\n", i, instruction->operand);
+				break;
+
+			case OPCODE_AND:
+			case OPCODE_OR:
+				fprintf(file, "\tif (do_short_circuit(vm, &code[%zu])) goto instruction_%u;\n", i, instruction->operand);
+				break;
+
+			case OPCODE_OPERATE_JUMP_IF_FALSE:
+				// skip over the jump instruction that was replaced
+				fprintf(file, "\tif (do_operate_jump_if_false(vm, &code[%zu])) goto instruction_%u;\n\tgoto instruction_%zu;\n", i, code[i + 1].operand, i + 2);
+				break;
+
+			case OPCODE_UPDATE_LEXICAL:
+				// skip over the instructions that were replaced
+				fprintf(file, "\tupdate_lexical_variable(vm, &code[%zu]);\n\tgoto instruction_%zu;\n", i, i + 4);
+				break;
+
+			case OPCODE_APPLY:
+				fprintf(file, "\tif (!do_apply(vm, &code[%zu])) {\n\t\tip = do_call(vm, &code[%zu]);\n\t\tgoto dispatch;\n\t}\n", i, i);
+				break;
+
+			case OPCODE_TAIL_APPLY:
+				fprintf(file, "\tif (!do_apply(vm, &code[%zu])) {\n\t\tip = do_tail_call(vm, &code[%zu]);\n\t\tgoto dispatch;\n\t}\n", i, i);
+				break;
+
+			case OPCODE_APPLY_LEXICAL:
+				// skip over the application instruction that was replaced
+				fprintf(file, "\tif (!do_apply_lexical(vm, &code[%zu])) {\n\t\tip = do_call_lexical(vm, &code[%zu]);\n\t\tgoto dispatch;\n\t}\n\tgoto instruction_%zu;\n", i, i, i + 2);
+				break;
+
+			case OPCODE_RETURN:
+				fprintf(file, "\tip = do_return(vm, &code[%zu]);\n\tif (ip == NULL) {\n\t\treturn pop_value(vm);\n\t}\n\tgoto dispatch;\n", i);
+				break;
+
+			case OPCODE_HALT:
+				fputs("\treturn NULL;\n", file);
+				break;
+
+			default:
+				// every other instruction is done by a call to its runtime function
+				if (OPCODE_FUNCTIONS[instruction->opcode] == NULL) {
+					whoops("cannot compile this instruction to C.");
+				}
 
-							// ensure that the Number supplied is, in fact, an integer
-							if (index_number->is_double) {
-								whoops("character value operator only accepts integer values in the second operand");
-							}
+				fprintf(file, "\t%s(vm, &code[%zu]);\n", OPCODE_FUNCTIONS[instruction->opcode], i);
+		}
+	}
 
-							String *subject_string = subject->value;
+	fputs("}\n\n", file);
+
+	fputs("// main procedure executed when the program is run\nint main(int argc, char *argv[]) {\n", file);
+	fputs("\t// the script runs with the interpreter's default settings, except that loops are never compiled to machine code since they are already compiled\n", file);
+	fputs("\tOptions options = {false, 4096, 1.0, false, isatty(fileno(stdout)) ? _IOLBF : _IOFBF, 0, false};\n\n", file);
+	fputs("\tif (argc > 1) {\n\t\twhoops(\"compiled scripts don't take any arguments.\");\n\t}\n\n", file);
+	fputs("\tsetvbuf(stdout, options.buffering == _IONBF ? NULL : output_buffer, options.buffering, sizeof(output_buffer));\n\n\tseed_rng();\n\n", file);
+	fputs("\t// the Elements of the Program are kept until the script finishes and are never garbage collected\n\tHeap *program_heap = Heap_new(0, 0);\n\tProgram *program = load_program(program_heap);\n\tmake_permanent(program_heap);\n\n", file);
+	fputs("\trun_script(NULL, program, run_compiled, &options);\n\n\tProgram_free(program);\n\tHeap_free(program_heap);\n\tfree_runtime();\n\n\treturn 0;\n}\n", file);
+
+	free(is_message);
+	free(constant_elements);
+	free(is_target);
+	free(is_entry);
+	free(elements);
+}
 
-							// if the index is out of range, return a Null Element
-							if (index_number->value_long < 0 || index_number->value_long > subject_string->length) {
-								return make(ELEMENT_NULL, NULL, heap);
-							}
+// function to compile a script string to C source code and write it to a file
+void compile_to_c(String *script, char *script_path, char *output_path) {
+	// the syntax tree is only needed until the Program has been written out
+	Heap *ast_heap = Heap_new(0, 0);
 
-							Number *result = Number_new();
+	Stack *tokens = tokenise(script, ast_heap);
+	Element *ast_root = construct_tree(tokens, ast_heap);
+	free(tokens);
 
-							// set the value of the result to the value of the byte at the index specified in the second operand
-							result->value_long = subject_string->content[index_number->value_long];
+	Program *program = compile_program(ast_root);
 
-							return make(ELEMENT_NUMBER, result, heap);
-						};
-						break;
+	FILE *file = fopen(output_path, "w");
+	if (file == NULL) {
+		puts(output_path);
+		whoops("cannot write to this output file.");
+	}
 
-					case OPERATION_CHAR_APPEND:
-						{
-							Element *subject = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, subject);
-							Element *char_code = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
+	write_program_as_c(program, script_path, file);
 
-							// both Elements must be of an acceptable type
-							if (subject->type != ELEMENT_STRING || char_code->type != ELEMENT_NUMBER) {
-								whoops("character append operator must be applied to a string and an integer, in that order");
-							}
+	if (fclose(file) != 0) {
+		puts(output_path);
+		whoops("cannot write to this output file.");
+	}
 
-							Number *char_code_number = char_code->value;
+	Program_free(program);
+	Heap_free(ast_heap);
 
-							// ensure that the Number supplied is, in fact, an integer
-							if (char_code_number->is_double) {
-								whoops("character append operator only accepts integer values in the second operand");
-							}
+	free_runtime();
+}
 
-							String *subject_string = subject->value;
+// function to execute a script string
+void execute(String *script, Options *options) {
+	// make a separate heap for the tokens and the abstract syntax tree, which are kept until the script finishes and are never garbage collected
+	Heap *ast_heap = Heap_new(0, 0);
 
-							// copy the contents of the old string into the new string, which will also have an additional byte of length
-							String *result = String_new(subject_string->length + 1);
-							memcpy(result->content, subject_string->content, subject_string->length);
+	// construct the list of tokens from the string
+	Stack *tokens = tokenise(script, ast_heap);
 
-							// set the value of the additional byte to the character value specified by the value of the second operand
-							result->content[subject_string->length] = char_code_number->value_long;
+	// construct the abstract syntax tree from the token list
+	Element *ast_root = construct_tree(tokens, ast_heap);
 
-							return make(ELEMENT_STRING, result, heap);
-						};
-						break;
+	// mark every Element of the syntax tree as permanently non-garbage
+	make_permanent(ast_heap);
 
-					case OPERATION_CLOSURE:
-						{
-							Stack *current_scopes = scopes->value;
+	// print a rough representation of the abstract syntax tree for debugging purposes
+	//print_value(ast_root, 0, true);
 
-							// create a copy of the current Scope collection so that its contents will be preserved until the closure is called
-							Element *scopes_copy = make(ELEMENT_SCOPE_COLLECTION, Stack_new(), heap);
-							for (size_t i = 0; i < current_scopes->length; i++) {
-								scopes_copy->value = Stack_push(scopes_copy->value, current_scopes->content[i]);
-							}
+	// we no longer have any use for the token list, so it should be freed
+	free(tokens);
 
-							// if a variable name is not specified, don't bother setting it
-							// otherwise, use the variable name specified
-							Element *variable = operation->element_a->type == ELEMENT_NULL ? NULL : operation->element_a;
+	if (options->tree_walk) {
+		// evaluate the syntax tree directly
+		run_script(ast_root, NULL, NULL, options);
+	} else {
+		// compile the syntax tree to bytecode and run it
+		Program *program = compile_program(ast_root);
+		run_script(NULL, program, run, options);
+		Program_free(program);
+	}
 
-							return make(ELEMENT_CLOSURE, Closure_new(operation->element_b, variable, scopes_copy), heap);
-						};
-						break;
+	// clean up everything that is left on the syntax tree's heap indiscriminately
+	Heap_free(ast_heap);
 
-					case OPERATION_ACCESS:
-						{
-							Element *subject = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							if (subject->type != ELEMENT_SCOPE) {
-								whoops("property access operation can only have a scope as a subject");
-							}
-
-							// retrieve the value from the scope, if any
-							Element *result = get_scope_mapping(subject->value, operation->element_b);
-							if (result == NULL) {
-								// if no result is found, print the property name and an error message
-								putchar('\n');
-								print_value(operation->element_b, 0, true);
-								whoops("no such property in this scope");
-							}
-
-							return result;
-						};
-						break;
+	free_runtime();
+}
 
-					case OPERATION_AND:
-					case OPERATION_OR:
-						{
-							// evaluate the first operand
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
+// function to run a script once with every loop compiled to machine code as soon as possible and once without any machine code, then check that both runs behaved the same way
+// each run happens in its own process, is given the same input and starts the random number generator from the same point
+// the output of the first run is printed if they match, and the exit status is the one that both runs finished with
+int check_conformance(String *script, Options *options) {
+	// keep all of the input so that it can be given to both runs
+	FILE *input = tmpfile();
+	int character;
+	while ((character = getchar()) != EOF) {
+		fputc(character, input);
+	}
+	fflush(input);
+	clearerr(stdin);
 
-							// return either the first or second operand evaluations based on whether or not the operation is && or || and whether or not the first operand evaluation is truthy
-							Element *result =
-								operation->type == OPERATION_AND != value_is_truthy(element_a) ? element_a :
-								evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
+	size_t jit_thresholds[2] = {1, 0};
+	FILE *outputs[2];
+	int statuses[2];
+	unsigned int seed = rand();
 
-							*keep_stack = Stack_pop(*keep_stack);
+	// make sure that nothing that is waiting to be printed is printed by the runs as well
+	fflush(stdout);
 
-							return result;
-						};
-						break;
+	for (int i = 0; i < 2; i++) {
+		outputs[i] = tmpfile();
 
-					case OPERATION_XOR:
-						{
-							Number *result = Number_new();
+		pid_t child = fork();
 
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
+		if (child == -1) {
+			whoops("cannot start a new process for the conformance check.");
+		}
 
-							// return a truthy value only if the truthiness of the two evaluations differ
-							result->value_long = value_is_truthy(element_a) != value_is_truthy(element_b) ? 1 : 0;
+		if (child == 0) {
+			// send everything that the run prints, including errors, to its own output file
+			lseek(fileno(input), 0, SEEK_SET);
+			dup2(fileno(input), STDIN_FILENO);
+			dup2(fileno(outputs[i]), STDOUT_FILENO);
+			dup2(fileno(outputs[i]), STDERR_FILENO);
 
-							// make a new Number Element to store the result and return it
-							return make(ELEMENT_NUMBER, result, heap);
-						};
-						break;
+			srand(seed);
+			options->jit_threshold = jit_thresholds[i];
+			execute(script, options);
 
-					case OPERATION_LIKENESS:
-						{
-							// evaluate each operand to obtain the actual values we need to operate on
-							Element *element_a = evaluate(operation->element_a, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_push(*keep_stack, element_a);
-							Element *element_b = evaluate(operation->element_b, ast_root, keep_stack, scopes_stack, heap);
-							*keep_stack = Stack_pop(*keep_stack);
+			fflush(stdout);
+			exit(0);
+		}
 
-							// create a new Number to store the result
-							Number *result = Number_new();
+		waitpid(child, &statuses[i], 0);
+		rewind(outputs[i]);
+	}
 
-							// set the Number element to 1 if the types are equal, otherwise 0
-							result->value_long = element_a->type == element_b->type ? 1 : 0;
+	// compare the outputs a character at a time
+	size_t position = 0;
+	int character_a;
+	int character_b;
+	do {
+		character_a = fgetc(outputs[0]);
+		character_b = fgetc(outputs[1]);
+		position++;
+	} while (character_a == character_b && character_a != EOF);
+
+	if (character_a != character_b || statuses[0] != statuses[1]) {
+		fprintf(stderr, "the runs with and without machine code first differ at character %zu of their output\n", position);
+		whoops("the script does not behave the same way with machine code as without it.");
+	}
 
-							// make a new Number Element to store the result and return it
-							return make(ELEMENT_NUMBER, result, heap);
-						};
-						break;
+	// print the output that both runs share
+	rewind(outputs[0]);
+	while ((character = fgetc(outputs[0])) != EOF) {
+		putchar(character);
+	}
 
-					default:
-						// throw an error if the user uses any operators that haven't been defined yet
-						whoops("operator not defined");
-				}
-			};
-			break;
+	fclose(input);
+	fclose(outputs[0]);
+	fclose(outputs[1]);
 
-		default:
-			return branch;
-	}
+	return WIFEXITED(statuses[0]) ? WEXITSTATUS(statuses[0]) : 1;
 }
 
-// function to execute a script string
-void execute(String *script) {
-	// make a new stack to keep track of all the elements that will be stored on the heap
-	// this will be useful for garbage collection later
-	Stack *heap = Stack_new();
+// main procedure executed when the program is run
+int main(int argc, char *argv[]) {
+	// by default, output to a terminal is written a line at a time so that the user sees it promptly, and anything else is written in large blocks
+	Options options = {false, 4096, 1.0, false, isatty(fileno(stdout)) ? _IOLBF : _IOFBF, JIT_THRESHOLD, false};
+
+	// handle any options that have been supplied before the sub-command
+	int argument_index = 1;
+	for (; argument_index < argc && strncmp(argv[argument_index], "--", 2) == 0; argument_index++) {
+		if (strcmp(argv[argument_index], "--tree-walk") == 0) {
+			options.tree_walk = true;
+		} else if (strcmp(argv[argument_index], "--gc-budget") == 0 || strcmp(argv[argument_index], "--gc-growth") == 0) {
+			// these options take a number as their value in the following argument
+			if (argument_index + 1 >= argc) {
+				puts(argv[argument_index]);
+				whoops("this option needs a number after it.");
+			}
 
-	// construct the list of tokens from the string
-	Stack *tokens = tokenise(script, &heap);
+			char *value = argv[argument_index + 1];
+			char *end;
+			double number = strtod(value, &end);
 
-	// construct the abstract syntax tree from the token list
-	Element *ast_root = construct_tree(tokens, &heap);
+			if (*value == '\0' || *end != '\0' || !(number >= 0)) {
+				puts(value);
+				whoops("this option needs a number that is not negative.");
+			}
 
-	// print a rough representation of the abstract syntax tree for debugging purposes
-	//print_value(ast_root, 0, true);
+			if (strcmp(argv[argument_index], "--gc-budget") == 0) {
+				options.gc_budget = number;
+			} else {
+				options.gc_growth = number;
+			}
 
-	// we no longer have any use for the token list, so it should be freed
-	free(tokens);
+			argument_index++;
+		} else if (strcmp(argv[argument_index], "--gc-stats") == 0) {
+			options.gc_stats = true;
+		} else if (strcmp(argv[argument_index], "--no-jit") == 0) {
+			options.jit_threshold = 0;
+		} else if (strcmp(argv[argument_index], "--conformance") == 0) {
+			options.conformance = true;
+		} else if (strcmp(argv[argument_index], "--buffer") == 0) {
+			// this option takes the buffering mode as its value in the following argument
+			if (argument_index + 1 >= argc) {
+				puts(argv[argument_index]);
+				whoops("this option needs 'none', 'line' or 'full' after it.");
+			}
+
+			char *value = argv[argument_index + 1];
 
-	// make a stack to temporarily keep track of certain objects so they don't get garbage collected prematurely
-	Stack *keep_stack = Stack_new();
+			if (strcmp(value, "none") == 0) {
+				options.buffering = _IONBF;
+			} else if (strcmp(value, "line") == 0) {
+				options.buffering = _IOLBF;
+			} else if (strcmp(value, "full") == 0) {
+				options.buffering = _IOFBF;
+			} else {
+				puts(value);
+				whoops("this option needs 'none', 'line' or 'full' after it.");
+			}
 
-	// make a stack to keep track of the previous sets of scopes so they don't get garbage collected prematurely
-	Stack *scopes_stack = Stack_new();
+			argument_index++;
+		} else {
+			puts(argv[argument_index]);
+			whoops("unknown option.");
+		}
+	}
 
-	// make the initial collection of scopes
-	scopes_stack = Stack_push(scopes_stack, make(ELEMENT_SCOPE_COLLECTION, Stack_new(), &heap));
+	// set up the output buffering before anything is printed
+	// the buffer is always flushed before reading input, before printing an error and when the program exits, so interactive scripts still work with any kind of buffering
+	setvbuf(stdout, options.buffering == _IONBF ? NULL : output_buffer, options.buffering, sizeof(output_buffer));
 
-	// evaluate the syntax tree
-	evaluate(ast_root, ast_root, &keep_stack, &scopes_stack, &heap);
+	// skip past the options so that the sub-command and its argument can be handled as usual
+	argc -= argument_index - 1;
+	argv += argument_index - 1;
 
-	// we no longer need these stacks after the evaluation so they can be safely freed
-	free(keep_stack);
-	free(scopes_stack);
+	// make sure that the user has supplied a script file to execute
+	if (argc < 3) {
+		whoops("please use one of the sub-commands 'run', 'eval' or 'compile' with an argument.");
+	}
 
-	// clean up any leftover garbage indiscriminately
-	garbage_collect(NULL, NULL, NULL, NULL, &heap);
+	if (strcmp(argv[1], "compile") == 0) {
+		// if the 'compile' command was used, compile the script file to C instead of running it
+		if (argc != 5 || strcmp(argv[3], "-o") != 0) {
+			whoops("the 'compile' sub-command needs a script file, then '-o' and the C file to write.");
+		}
 
-	// there should be nothing really left to clean up, so the heap stack is no longer needed and should be freed
-	free(heap);
-}
+		String *script = read_file(argv[2]);
+		if (script == NULL) {
+			whoops("cannot read this script file");
+		}
 
-// procedure to seed the RNG using the system clock and CPU tick count, then generate one random number to shuffle it up a little
-// this seems to give pretty good random numbers
-void seed_rng() {
-	srand(time(NULL) * clock());
-	rand();
-}
+		compile_to_c(script, argv[2], argv[4]);
 
-// main procedure executed when the program is run
-int main(int argc, char *argv[]) {
-	// disable line buffering
-	setbuf(stdout, NULL);
+		String_free(script);
 
-	// make sure that the user has supplied a script file to execute
-	if (argc < 3) {
-		whoops("please use one of the sub-commands 'run' or 'eval' with an argument.");
+		return 0;
 	}
 
 	if (argc > 3) {
@@ -2516,11 +1994,17 @@ int main(int argc, char *argv[]) {
 		whoops("unknown command.");
 	}
 
+	if (options.conformance) {
+		int status = check_conformance(script, &options);
+		String_free(script);
+		return status;
+	}
+
 	// evaluate and execute the script
-	execute(script);
+	execute(script, &options);
 
 	// free the memory that the script uses because we won't need it again
-	free(script);
+	String_free(script);
 
 	return 0;
 }
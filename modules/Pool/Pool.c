@@ -0,0 +1,56 @@
+// module that adds a Pool type that hands out many small items of the same size quickly by carving them out of large slabs of memory
+// items that are given back to a Pool are kept in a list so that they can be reused by later allocations
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "Pool.h"
+
+// the number of bytes in each slab, not including the pointer at the start of each slab that links it to the previous one
+#define POOL_SLAB_SIZE 65536
+
+// function to get an item from a Pool, either by reusing one that was given back or by taking the next unused item from the current slab
+void *Pool_alloc(Pool *pool) {
+	// reuse the most recently free'd item if there is one
+	// free'd items store a pointer to the next free'd item in their first bytes
+	if (pool->free_items != NULL) {
+		void *item = pool->free_items;
+		pool->free_items = *(void**)item;
+		return item;
+	}
+
+	// if the current slab has run out of items, start a new one
+	if (pool->next_item == NULL || pool->next_item + pool->item_size > pool->slab_end) {
+		char *slab = malloc(sizeof(void*) + POOL_SLAB_SIZE);
+
+		// link the slab to the previous one so that they can all be free'd at once later
+		*(void**)slab = pool->slabs;
+		pool->slabs = slab;
+
+		pool->next_item = slab + sizeof(void*);
+		pool->slab_end = slab + sizeof(void*) + POOL_SLAB_SIZE;
+	}
+
+	void *item = pool->next_item;
+	pool->next_item += pool->item_size;
+	return item;
+}
+
+// function to give an item back to a Pool so that it can be reused
+void Pool_free(Pool *pool, void *item) {
+	*(void**)item = pool->free_items;
+	pool->free_items = item;
+}
+
+// function to free every slab of a Pool at once, including any items that were never given back
+void Pool_destroy(Pool *pool) {
+	while (pool->slabs != NULL) {
+		void *previous = *(void**)pool->slabs;
+		free(pool->slabs);
+		pool->slabs = previous;
+	}
+
+	pool->free_items = NULL;
+	pool->next_item = NULL;
+	pool->slab_end = NULL;
+}
@@ -0,0 +1,20 @@
+#ifndef POOL_H
+#define POOL_H
+
+typedef struct {
+	size_t item_size;
+	void *free_items;
+	char *next_item;
+	char *slab_end;
+	void *slabs;
+} Pool;
+
+#define POOL_OF(type) {sizeof(type) < sizeof(void*) ? sizeof(void*) : (sizeof(type) + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*), NULL, NULL, NULL, NULL}
+
+void *Pool_alloc(Pool*);
+
+void Pool_free(Pool*, void*);
+
+void Pool_destroy(Pool*);
+
+#endif
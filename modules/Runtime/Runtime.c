@@ -0,0 +1,4043 @@
+// module that contains everything needed to run a script once it has been parsed, which is shared by the interpreter and by scripts compiled to C
+// this includes the values of the language, the garbage collector, the tree-walking evaluator, the bytecode virtual machine and the loop compiler
+
+// import the necessary built-in libraries
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <float.h>
+#include <math.h>
+#include <time.h>
+
+#include "Runtime.h"
+
+#ifdef JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+// function to spit out an error and kill the program if/when necessary
+void whoops(char *reason) {
+	// make sure that anything the script has printed so far shows up before the error
+	fflush(stdout);
+
+	fputs("\nERROR: ", stderr);
+	fputs(reason, stderr);
+	fputc('\n', stderr);
+	exit(1);
+}
+
+// function to return a new String object containing the contents of a file
+String *read_file(char *path) {
+	// open the script file for reading, or return NULL if it can't be opened
+	FILE *file_pointer = fopen(path, "rb");
+	if (file_pointer == NULL) {
+		return NULL;
+	}
+
+	// seek to the end and get the position after the last character
+	fseek(file_pointer, 0, SEEK_END);
+	long file_size = ftell(file_pointer);
+
+	// return to the start to read the file
+	fseek(file_pointer, 0, SEEK_SET);
+
+	// make a new string to store the script
+	String *file_content = String_new(file_size);
+
+	// store the file contents in the string
+	fread(file_content->content, 1, file_size, file_pointer);
+
+	// close the file so it doesn't reside in memory forever
+	fclose(file_pointer);
+
+	return file_content;
+}
+
+// function to attempt to write a String to a file and return true only if the operation was successful
+bool write_file(char *path, String *new_contents) {
+	// try to open the file for writing and return false if this doesn't happen
+	FILE *file_pointer = fopen(path, "wb");
+	if (file_pointer == NULL) {
+		return false;
+	}
+
+	// return true only if the entire contents were successfully written to the file
+	bool result = fwrite(new_contents->content, 1, new_contents->length, file_pointer) == new_contents->length;
+
+	// close the file so it doesn't reside in memory forever
+	fclose(file_pointer);
+
+	return result;
+}
+
+// pool that all Elements are allocated from
+Pool element_pool = POOL_OF(Element);
+
+// function to make and initialise a new Element
+Element *Element_new(ElementType type, void *value) {
+	Element *new_element = Pool_alloc(&element_pool);
+	new_element->type = type;
+	new_element->gc_checked = false;
+	new_element->gc_old = false;
+	new_element->gc_remembered = false;
+	new_element->value = value;
+	return new_element;
+}
+
+// array storing the name of each command, in the same order as the CommandType enumeration
+char *const COMMAND_NAMES[] = {"do", "return", "print", "show", "whoops", "rand", "length", "input", "readfile", "writefile", "if", "while", "let", "set", "mut", "unmap", "edit", "delete", "keys", "values"};
+
+// pool that all Operations are allocated from
+Pool operation_pool = POOL_OF(Operation);
+
+// function to make and initialise a new Operation
+Operation *Operation_new(OperationType type, Element *a, Element *b) {
+	Operation *new_operation = Pool_alloc(&operation_pool);
+	new_operation->type = type;
+	new_operation->element_a = a;
+	new_operation->element_b = b;
+	return new_operation;
+}
+
+// function to perform operations on numbers
+Number perform_numeric_operation(OperationType operation_type, Number *number_a, Number *number_b) {
+	Number result = {0};
+
+	// the result should usually be a floating-point value if either operand is one already
+	result.is_double = number_a->is_double || number_b->is_double;
+
+	// most of these operations follow the same format:
+	// if one of the operands is floating-point, then perform the operation using the appropriate property for each number (value_double or value_long) depending on the type of number it is
+	// otherwise, just perform the operation using value_long for both numbers
+	switch (operation_type) {
+		case OPERATION_ADDITION:
+			if (result.is_double) {
+				result.value_double =
+					(number_a->is_double ? number_a->value_double : number_a->value_long) +
+					(number_b->is_double ? number_b->value_double : number_b->value_long);
+			} else {
+				result.value_long = number_a->value_long + number_b->value_long;
+			}
+			break;
+		case OPERATION_SUBTRACTION:
+			if (result.is_double) {
+				result.value_double =
+					(number_a->is_double ? number_a->value_double : number_a->value_long) -
+					(number_b->is_double ? number_b->value_double : number_b->value_long);
+			} else {
+				result.value_long = number_a->value_long - number_b->value_long;
+			}
+			break;
+		case OPERATION_MULTIPLICATION:
+			if (result.is_double) {
+				result.value_double =
+					(number_a->is_double ? number_a->value_double : number_a->value_long) *
+					(number_b->is_double ? number_b->value_double : number_b->value_long);
+			} else {
+				result.value_long = number_a->value_long * number_b->value_long;
+			}
+			break;
+		case OPERATION_DIVISION:
+			// if the denomintor is zero or there is no clean integer division, make the result floating-point
+			if (number_b->value_long == 0 || number_a->value_long % number_b->value_long != 0) {
+				result.is_double = true;
+			}
+
+			if (result.is_double) {
+				// if the result needs to be floating-point, convert the operands to floating-point
+				double double_a = number_a->is_double ? number_a->value_double : number_a->value_long;
+				double double_b = number_b->is_double ? number_b->value_double : number_b->value_long;
+
+				// if the denominator is zero, use the appropriate infinity value
+				// otherwise, perform regular floating-point division
+				result.value_double = double_b == 0 ? (double_a == 0 ? NAN : double_a > 0 ? INFINITY : -INFINITY) : double_a / double_b;
+			} else {
+				// if the two values are normal integers and the denominator isn't zero, just use integer division
+				result.value_long = number_a->value_long / number_b->value_long;
+			}
+			break;
+
+		case OPERATION_REMAINDER:
+			// the remainder operator only applies to integers
+			if (result.is_double) {
+				whoops("cannot apply remainder operation to floating-point values");
+			} else {
+				result.value_long = number_a->value_long % number_b->value_long;
+			}
+			break;
+
+		case OPERATION_POW:
+			// the pow() function only works on doubles and only returns a double, so the result is a double
+			result.is_double = true;
+
+			// convert each operand to a double
+			double double_a = number_a->is_double ? number_a->value_double : number_a->value_long;
+			double double_b = number_b->is_double ? number_b->value_double : number_b->value_long;
+
+			result.value_double = pow(double_a, double_b);
+			break;
+
+		case OPERATION_LT:
+		case OPERATION_GT:
+			// switch the operands around for the other operator so we don't have to write the same logic twice
+			if (operation_type == OPERATION_GT) {
+				Number *temp = number_a;
+				number_a = number_b;
+				number_b = temp;
+			}
+
+			// the result will only be 1/0 for true/false so it should be an integer
+			result.is_double = false;
+
+			result.value_long =
+				(number_a->is_double ? number_a->value_double : number_a->value_long) <
+				(number_b->is_double ? number_b->value_double : number_b->value_long);
+			break;
+
+		case OPERATION_LTE:
+		case OPERATION_GTE:
+			// switch the operands around for the other operator so we don't have to write the same logic twice
+			if (operation_type == OPERATION_GTE) {
+				Number *temp = number_a;
+				number_a = number_b;
+				number_b = temp;
+			}
+
+			// the result will only be 1/0 for true/false so it should be an integer
+			result.is_double = false;
+
+			result.value_long =
+				(number_a->is_double ? number_a->value_double : number_a->value_long) <=
+				(number_b->is_double ? number_b->value_double : number_b->value_long);
+			break;
+	}
+
+	return result;
+}
+
+// function to perform a numeric operation on two integers directly, for operator sites that have only seen integers so far
+// gives the same result as perform_numeric_operation, but returns false without a result for the cases that it doesn't handle, such as division that doesn't come out exactly
+bool operate_on_integers(OperationType operation_type, long a, long b, Number *result) {
+	result->is_double = false;
+
+	switch (operation_type) {
+		case OPERATION_ADDITION:
+			result->value_long = a + b;
+			return true;
+		case OPERATION_SUBTRACTION:
+			result->value_long = a - b;
+			return true;
+		case OPERATION_MULTIPLICATION:
+			result->value_long = a * b;
+			return true;
+		case OPERATION_DIVISION:
+			if (b == 0 || a % b != 0) {
+				return false;
+			}
+			result->value_long = a / b;
+			return true;
+		case OPERATION_REMAINDER:
+			if (b == 0) {
+				return false;
+			}
+			result->value_long = a % b;
+			return true;
+		case OPERATION_POW:
+			result->is_double = true;
+			result->value_double = pow(a, b);
+			return true;
+
+		// comparisons are made between floating-point values, just as they are in perform_numeric_operation
+		case OPERATION_LT:
+			result->value_long = (double)a < (double)b;
+			return true;
+		case OPERATION_GT:
+			result->value_long = (double)a > (double)b;
+			return true;
+		case OPERATION_LTE:
+			result->value_long = (double)a <= (double)b;
+			return true;
+		case OPERATION_GTE:
+			result->value_long = (double)a >= (double)b;
+			return true;
+	}
+
+	return false;
+}
+
+// function to perform a numeric operation on two floating-point values directly, for operator sites that have only seen floating-point values so far
+// returns false without a result for the operations that can't be applied to floating-point values
+bool operate_on_doubles(OperationType operation_type, double a, double b, Number *result) {
+	result->is_double = true;
+
+	switch (operation_type) {
+		case OPERATION_ADDITION:
+			result->value_double = a + b;
+			return true;
+		case OPERATION_SUBTRACTION:
+			result->value_double = a - b;
+			return true;
+		case OPERATION_MULTIPLICATION:
+			result->value_double = a * b;
+			return true;
+		case OPERATION_DIVISION:
+			result->value_double = b == 0 ? (a == 0 ? NAN : a > 0 ? INFINITY : -INFINITY) : a / b;
+			return true;
+		case OPERATION_POW:
+			result->value_double = pow(a, b);
+			return true;
+
+		// comparisons give integer results
+		case OPERATION_LT:
+			result->is_double = false;
+			result->value_long = a < b;
+			return true;
+		case OPERATION_GT:
+			result->is_double = false;
+			result->value_long = a > b;
+			return true;
+		case OPERATION_LTE:
+			result->is_double = false;
+			result->value_long = a <= b;
+			return true;
+		case OPERATION_GTE:
+			result->is_double = false;
+			result->value_long = a >= b;
+			return true;
+	}
+
+	return false;
+}
+
+// the Shape of Scopes with no mappings, which every Scope starts with
+Shape empty_shape = {NULL, 0, NULL};
+
+// every Shape other than the empty one, so that they can all be free'd once the script finishes
+Stack *shapes = NULL;
+
+// function to get the Shape that a Scope of a certain Shape has once a certain property name is added to it
+Shape *add_shape_key(Shape *shape, Element *key) {
+	if (shape->transitions == NULL) {
+		shape->transitions = Stack_new();
+	}
+
+	// reuse the existing Shape if another Scope has already had the same property name added to it
+	// property names are interned, so they can be compared by their location
+	for (size_t i = 0; i < shape->transitions->length; i++) {
+		Shape *transition = shape->transitions->content[i];
+		if (transition->key == key) {
+			return transition;
+		}
+	}
+
+	Shape *new_shape = malloc(sizeof(Shape));
+	new_shape->key = key;
+	new_shape->length = shape->length + 1;
+	new_shape->transitions = NULL;
+
+	shape->transitions = Stack_push(shape->transitions, new_shape);
+
+	if (shapes == NULL) {
+		shapes = Stack_new();
+	}
+	shapes = Stack_push(shapes, new_shape);
+
+	return new_shape;
+}
+
+// function to free every Shape that has been made
+void free_shapes() {
+	free(empty_shape.transitions);
+	empty_shape.transitions = NULL;
+
+	if (shapes == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < shapes->length; i++) {
+		Shape *shape = shapes->content[i];
+		free(shape->transitions);
+		free(shape);
+	}
+
+	free(shapes);
+	shapes = NULL;
+}
+
+// pool that all Scopes are allocated from
+Pool scope_pool = POOL_OF(Scope);
+
+// function to make and initialise a new Scope object
+Scope *Scope_new(Element *parent) {
+	Scope *new_scope = Pool_alloc(&scope_pool);
+	new_scope->parent = parent;
+	new_scope->changed_dynamically = false;
+	new_scope->shape = &empty_shape;
+	new_scope->length = 0;
+	new_scope->used = 0;
+	new_scope->capacity = 0;
+	new_scope->maps = NULL;
+	new_scope->index = NULL;
+	new_scope->index_capacity = 0;
+	new_scope->indexed = 0;
+	new_scope->dense = NULL;
+	new_scope->dense_length = 0;
+	new_scope->dense_capacity = 0;
+	return new_scope;
+}
+
+// function to free a Scope object along with its list of mappings and its hash index
+void Scope_free(Scope *scope) {
+	free(scope->maps);
+	free(scope->index);
+	free(scope->dense);
+	Pool_free(&scope_pool, scope);
+}
+
+// function to compare two Elements a and b
+bool compare_elements(Element *element_a, Element *element_b) {
+	// handle the case where at least one of the elements is invalid
+	if (element_a == NULL || element_b == NULL) {
+		return false;
+	}
+
+	// if the same Element is being passed to both arguments, then they are equal
+	if (element_a == element_b) {
+		return true;
+	}
+
+	// elements must be of the same type to be equal
+	if (element_a->type != element_b->type) {
+		return false;
+	}
+
+	switch (element_a->type) {
+		case ELEMENT_NULL:
+			// there is only one value that Null Elements can be, and we already know that the type is the same, so these elements must be equal
+			return true;
+
+		case ELEMENT_VARIABLE:
+			// every variable name is interned when the script is tokenised, so variable names with the same characters are always the same Element
+			// since we already know that these Elements are different, their names must be different too
+			return false;
+
+		case ELEMENT_STRING:
+			// strings can be compared by comparing their lengths and each character in them
+			{
+				String *string_a = element_a->value;
+				String *string_b = element_b->value;
+
+				// if the lengths are different, the strings are different
+				if (string_a->length != string_b->length) {
+					return false;
+				}
+
+				// if the hashes of both strings have already been calculated and they are different, the strings are different
+				if (string_a->hash != 0 && string_b->hash != 0 && string_a->hash != string_b->hash) {
+					return false;
+				}
+
+				// iterate through each character in both strings and if any character differs, then the strings differ
+				for (size_t i = 0; i < string_a->length; i++) {
+					if (string_a->content[i] != string_b->content[i]) {
+						return false;
+					}
+				}
+
+				// if each corresponding character is equal and the lengths are equal, the string must be equal
+				return true;
+			};
+			break;
+
+		case ELEMENT_NUMBER:
+			{
+				Number *number_a = element_a->value;
+				Number *number_b = element_b->value;
+
+				// each number can be either a double or long, so each combination of doubles and longs must be considered
+				if (number_a->is_double) {
+					if (number_b->is_double) {
+						return number_a->value_double == number_b->value_double;
+					} else {
+						return number_a->value_double == number_b->value_long;
+					}
+				} else {
+					if (number_b->is_double) {
+						return number_a->value_long == number_b->value_double;
+					} else {
+						return number_a->value_long == number_b->value_long;
+					}
+				}
+			};
+			break;
+
+		case ELEMENT_SCOPE:
+			{
+				Scope *scope_a = element_a->value;
+				Scope *scope_b = element_b->value;
+
+				// scopes with differing numbers of mappings must not be equal
+				if (scope_a->length != scope_b->length) {
+					return false;
+				}
+
+				// the scopes are not equal if any of the mappings differ
+				for (size_t i = 0; i < scope_a->used; i++) {
+					if (scope_a->maps[i].key != NULL && !compare_elements(get_scope_mapping(scope_b, scope_a->maps[i].key), scope_a->maps[i].value)) {
+						return false;
+					}
+				}
+
+				// if the lengths are the same and the mappings are the same, the scopes must be equal
+				return true;
+			};
+			break;
+	}
+
+	// Elements that for whatever reason cannot be compared are considered non-equal
+	return false;
+}
+
+// function to mix the bits of a 64-bit value so that similar values end up in very different hash buckets
+uint64_t mix_hash(uint64_t hash) {
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb33fe63a53b9ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+// function to calculate the hash of an Element such that any two Elements that compare_elements() considers equal have the same hash
+uint64_t hash_element(Element *element) {
+	switch (element->type) {
+		case ELEMENT_VARIABLE:
+		case ELEMENT_STRING:
+			// string-like values are hashed by their characters, which is only done once for each String
+			return mix_hash(String_hash(element->value) ^ element->type);
+
+		case ELEMENT_NUMBER:
+			{
+				Number *number = element->value;
+
+				// integers are compared with floating-point values by converting them, so hash every number by its floating-point value
+				// this makes sure that 1 and 1.0 end up with the same hash
+				double value = number->is_double ? number->value_double : number->value_long;
+
+				// 0.0 and -0.0 are equal but have different bits, so make sure that they hash the same way
+				if (value == 0) {
+					value = 0;
+				}
+
+				uint64_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+
+				return mix_hash(bits);
+			};
+			break;
+
+		case ELEMENT_NULL:
+		case ELEMENT_SCOPE:
+			// Null values are all equal, and Scopes are compared by their contents, which can change after they are used as keys
+			// so every value of these types is given the same hash
+			return mix_hash(element->type);
+
+		default:
+			// all other Elements are only equal to themselves, so they can be hashed by their location
+			return mix_hash((uintptr_t)element);
+	}
+}
+
+// function to get the integer that a key represents if it is a non-negative integer, so that it can be looked up in the dense part of a Scope
+// the result is -1 for any other key
+long dense_scope_key(Element *key) {
+	if (key->type != ELEMENT_NUMBER) {
+		return -1;
+	}
+
+	Number *number = key->value;
+
+	if (!number->is_double) {
+		return number->value_long >= 0 ? number->value_long : -1;
+	}
+
+	// floating-point keys are equal to the integer with the same value, so they have to be found in the same place
+	if (number->value_double >= 0 && number->value_double <= 9007199254740992.0 && floor(number->value_double) == number->value_double) {
+		return number->value_double;
+	}
+
+	return -1;
+}
+
+// function to check whether a key belongs in the dense part of a Scope
+bool in_dense_scope_part(Scope *scope, Element *key) {
+	long dense_key = dense_scope_key(key);
+	return dense_key >= 0 && (size_t)dense_key < scope->dense_length;
+}
+
+// function to add the mapping at a certain position in a Scope's list of mappings to its hash index
+void index_scope_mapping(Scope *scope, size_t position) {
+	size_t mask = scope->index_capacity - 1;
+
+	// find the first empty bucket at or after the bucket that the key hashes to
+	size_t bucket = hash_element(scope->maps[position].key) & mask;
+	while (scope->index[bucket] != 0) {
+		bucket = (bucket + 1) & mask;
+	}
+
+	scope->index[bucket] = position + 1;
+}
+
+// function to remove the leftovers of deleted mappings from a Scope and rebuild its hash index if it needs one
+void compact_scope(Scope *scope) {
+	// shift every remaining mapping back to fill the gaps left by deleted mappings, keeping them in their original order
+	// the number of mappings that have to be added to the index is counted along the way
+	size_t kept = 0;
+	size_t indexed = 0;
+	for (size_t i = 0; i < scope->used; i++) {
+		if (scope->maps[i].key != NULL) {
+			scope->maps[kept] = scope->maps[i];
+
+			// keep the positions of the keys in the dense part up to date
+			if (in_dense_scope_part(scope, scope->maps[kept].key)) {
+				scope->dense[dense_scope_key(scope->maps[kept].key)] = kept;
+			} else {
+				indexed++;
+			}
+
+			kept++;
+		}
+	}
+	scope->used = kept;
+
+	free(scope->index);
+	scope->index = NULL;
+	scope->index_capacity = 0;
+	scope->indexed = 0;
+
+	// small Scopes are searched directly, so they don't need an index
+	if (scope->used <= SCOPE_INDEX_THRESHOLD) {
+		return;
+	}
+
+	// make the index at least twice as big as the number of mappings in it so that there are plenty of empty buckets to end each search
+	scope->index_capacity = 16;
+	while (scope->index_capacity < indexed * 2) {
+		scope->index_capacity *= 2;
+	}
+
+	scope->index = calloc(scope->index_capacity, sizeof(size_t));
+	for (size_t i = 0; i < scope->used; i++) {
+		if (!in_dense_scope_part(scope, scope->maps[i].key)) {
+			index_scope_mapping(scope, i);
+		}
+	}
+	scope->indexed = indexed;
+}
+
+// function to find the position of the mapping for a certain key in a Scope's list of mappings
+// if there is no such mapping, the length of the list is returned instead
+size_t find_scope_mapping(Scope *scope, Element *key) {
+	// keys in the dense part of the Scope can be found directly
+	if (scope->dense_length > 0 && in_dense_scope_part(scope, key)) {
+		size_t position = scope->dense[dense_scope_key(key)];
+		return position == SIZE_MAX ? scope->used : position;
+	}
+
+	if (scope->index == NULL) {
+		// search through all mappings in small Scopes directly
+		for (size_t i = 0; i < scope->used; i++) {
+			if (scope->maps[i].key != NULL && compare_elements(scope->maps[i].key, key)) {
+				return i;
+			}
+		}
+
+		return scope->used;
+	}
+
+	size_t mask = scope->index_capacity - 1;
+
+	// check each bucket from the one that the key hashes to until an empty bucket is found
+	for (size_t bucket = hash_element(key) & mask; scope->index[bucket] != 0; bucket = (bucket + 1) & mask) {
+		size_t position = scope->index[bucket] - 1;
+
+		// buckets pointing to deleted mappings are skipped over but don't end the search
+		if (scope->maps[position].key != NULL && compare_elements(scope->maps[position].key, key)) {
+			return position;
+		}
+	}
+
+	return scope->used;
+}
+
+// function to edit the mapping within a Scope for a certain key, creating one if it doesn't exist yet
+Scope *set_scope_mapping(Scope *scope, Element *key, Element *value) {
+	// update the value of a matching Map if one is found
+	size_t position = find_scope_mapping(scope, key);
+	if (position < scope->used) {
+		scope->maps[position].value = value;
+		return scope;
+	}
+
+	// if no matching Map is found, make room for an additional Map, growing the list geometrically so that building a large Scope isn't slowed down by reallocation
+	if (scope->used == scope->capacity) {
+		scope->capacity = scope->capacity == 0 ? 4 : scope->capacity * 2;
+		scope->maps = realloc(scope->maps, scope->capacity * sizeof(Map));
+	}
+
+	// configure the properties of the new Map so that it maps the key to the new value
+	scope->maps[scope->used].key = key;
+	scope->maps[scope->used].value = value;
+
+	scope->used++;
+	scope->length++;
+
+	// Scopes keep track of their Shape for as long as all of their keys are property names
+	if (scope->shape != NULL) {
+		scope->shape = key->type == ELEMENT_VARIABLE ? add_shape_key(scope->shape, key) : NULL;
+	}
+
+	long dense_key = dense_scope_key(key);
+
+	if (dense_key >= 0 && (size_t)dense_key <= scope->dense_length) {
+		if ((size_t)dense_key == scope->dense_length) {
+			// the key comes straight after the end of the dense part, so the dense part can grow to include it
+			if (scope->dense_length == scope->dense_capacity) {
+				scope->dense_capacity = scope->dense_capacity == 0 ? 8 : scope->dense_capacity * 2;
+				scope->dense = realloc(scope->dense, scope->dense_capacity * sizeof(size_t));
+			}
+
+			scope->dense_length++;
+		}
+
+		// otherwise, the key is filling in a gap left by a deleted key
+		scope->dense[dense_key] = scope->used - 1;
+
+		// small Scopes still need an index for their other keys once they become too big to search through directly
+		if (scope->index == NULL && scope->used > SCOPE_INDEX_THRESHOLD) {
+			compact_scope(scope);
+		}
+
+		return scope;
+	}
+
+	scope->indexed++;
+
+	if (scope->index == NULL) {
+		// give the Scope an index once it becomes too big to search through directly
+		if (scope->used > SCOPE_INDEX_THRESHOLD) {
+			compact_scope(scope);
+		}
+	} else if (scope->indexed * 4 > scope->index_capacity * 3) {
+		// once the index starts to fill up, rebuild it with more buckets
+		// this also clears out any leftovers from deleted mappings
+		compact_scope(scope);
+	} else {
+		index_scope_mapping(scope, scope->used - 1);
+	}
+
+	return scope;
+}
+
+// function to get a value mapped to a certain key in a Scope
+Element *get_scope_mapping(Scope *scope, Element *key) {
+	size_t position = find_scope_mapping(scope, key);
+
+	// if there is no matching element, return NULL
+	if (position == scope->used) {
+		return NULL;
+	}
+
+	return scope->maps[position].value;
+}
+
+// function to determine whether or not a mapping is present within a Scope with a matching key
+bool check_scope_mapping(Scope *scope, Element *key) {
+	return find_scope_mapping(scope, key) < scope->used;
+}
+
+// function to delete a mapping in a Scope
+Scope *delete_scope_mapping(Scope *scope, Element *key) {
+	size_t position = find_scope_mapping(scope, key);
+
+	// if no matching key was ever found, do not change the scope
+	if (position == scope->used) {
+		return scope;
+	}
+
+	// the positions of the mappings after this one can change once the gap is tidied up, so the Scope no longer has a Shape
+	scope->shape = NULL;
+
+	// keys in the dense part of the Scope leave a gap there as well
+	if (in_dense_scope_part(scope, key)) {
+		scope->dense[dense_scope_key(key)] = SIZE_MAX;
+	}
+
+	// leave a gap where the mapping used to be so that the positions of the other mappings don't change
+	scope->maps[position].key = NULL;
+	scope->maps[position].value = NULL;
+
+	scope->length--;
+
+	// small Scopes are kept free of gaps, whilst bigger Scopes are only tidied up once at least half of their list is made up of gaps
+	if (scope->index == NULL || scope->length * 2 < scope->used) {
+		compact_scope(scope);
+	}
+
+	return scope;
+}
+
+// function to print Elements to the console based on their type
+void print_value(Element *element, int indentation, bool literal) {
+	// make sure that the Element actually exists first
+	if (element == NULL) {
+		return;
+	}
+
+	switch (element->type) {
+		case ELEMENT_NULL:
+			putchar('(');
+			putchar(')');
+			break;
+
+		case ELEMENT_NUMBER:
+			{
+				Number *number = element->value;
+
+				if (number->is_double) {
+					// if the number is a floating-point value, print it to the maximum number of decimal places necessary to represent it exactly
+					printf("%.*g", DBL_DECIMAL_DIG, number->value_double);
+				} else {
+					// if the number is a long integer, just print it
+					printf("%ld", number->value_long);
+				}
+			};
+			break;
+
+		case ELEMENT_VARIABLE:
+			// print the name of the variable as it is
+			String_print(element->value);
+			break;
+
+		case ELEMENT_STRING:
+			if (literal) {
+				// if we are supposed to print the Element as a literal element, print it as a correctly-formatted ash-script string
+
+				String *string = element->value;
+
+				putchar('"');
+
+				for (size_t i = 0; i < string->length; i++) {
+					// when a quote is found, it should be escaped by a backslash
+					if (string->content[i] == '"') {
+						putchar('\\');
+					}
+
+					// re-create some of the escape sequences
+					if (string->content[i] == '\n') {
+						putchar('\\');
+						putchar('n');
+					} else if (string->content[i] == '\r') {
+						putchar('\\');
+						putchar('r');
+					} else if (string->content[i] == '\t') {
+						putchar('\\');
+						putchar('t');
+					} else {
+						putchar(string->content[i]);
+					}
+				}
+
+				putchar('"');
+			} else {
+				// otherwise, just dump the contents to the console
+				String_print(element->value);
+			}
+			break;
+
+		case ELEMENT_SCOPE:
+			{
+				Scope *scope = element->value;
+
+				putchar('{');
+				putchar('\n');
+
+				// iterate through all the mappings in the Scope
+				for (size_t i = 0; i < scope->used; i++) {
+					// skip over the gaps left by deleted mappings
+					if (scope->maps[i].key == NULL) {
+						continue;
+					}
+
+					// correctly indent each line of the Scope
+					for (int i = 0; i < indentation + 1; i++) {
+						putchar('\t');
+					}
+
+					// print a 'let' statement defining each key and value in the scope
+					fputs("let ", stdout);
+					print_value(scope->maps[i].key, indentation + 1, true);
+					putchar(' ');
+					print_value(scope->maps[i].value, indentation + 1, true);
+					putchar(';');
+					putchar('\n');
+				}
+
+				// correctly indent the last line of the Scope
+				for (int i = 0; i < indentation; i++) {
+					putchar('\t');
+				}
+
+				putchar('}');
+			};
+			break;
+
+		case ELEMENT_SEQUENCE:
+			{
+				Stack *sequence = element->value;
+
+				putchar('{');
+				putchar('\n');
+
+				// iterate through each statement in the sequence and print it
+				for (size_t i = 0; i < sequence->length; i++) {
+					Stack *statement = sequence->content[i];
+
+					// correctly indent each line of the Scope
+					for (int i = 0; i < indentation + 1; i++) {
+						putchar('\t');
+					}
+
+					// iterate through each Element in the statement and print it
+					for (size_t i = 0; i < statement->length; i++) {
+						print_value(statement->content[i], indentation + 1, true);
+						putchar(' ');
+					}
+
+					putchar(';');
+					putchar('\n');
+				}
+
+				// correctly indent the last line of the Sequence
+				for (int i = 0; i < indentation; i++) {
+					putchar('\t');
+				}
+
+				putchar('}');
+			};
+			break;
+
+		case ELEMENT_OPERATION:
+			{
+				Operation *operation = element->value;
+
+				putchar('(');
+				print_value(operation->element_a, indentation, true);
+
+				// since we only get to print Operations if we're debugging the parsing logic, it's good enough to just print a placeholder indicating which operation it is
+				printf(" [%d] ", operation->type);
+
+				print_value(operation->element_b, indentation, true);
+				putchar(')');
+			};
+			break;
+
+		case ELEMENT_CLOSURE:
+			// Closures can't easily be represented in text due to their Scope-containing nature, so just print a placeholder
+			fputs("[=>]", stdout);
+			break;
+
+		case ELEMENT_COMMAND:
+			// print the name of the command that the Element represents
+			fputs(COMMAND_NAMES[(uintptr_t)element->value], stdout);
+			break;
+
+		default:
+			// if the Element does not have its type listed above, print a placeholder indicating its type
+			printf("[E %d]", element->type);
+	}
+}
+
+// function to determine whether or not an Element has a truthy value
+bool value_is_truthy(Element *element) {
+	switch (element->type) {
+		case ELEMENT_NULL:
+			// Null Elements are never truthy
+			return false;
+
+		case ELEMENT_NUMBER:
+			// Number Elements are truthy if they do not equal 0 or NAN
+			{
+				Number *number = element->value;
+
+				if (number->is_double) {
+					return number->value_double != 0 && number->value_double != NAN;
+				} else {
+					return number->value_long != 0;
+				}
+			};
+			break;
+		case ELEMENT_STRING:
+			// String Elements are truthy if they are not empty
+			{
+				String *string = element->value;
+
+				return string->length != 0;
+			};
+			break;
+		case ELEMENT_SCOPE:
+			// Scope Elements are truthy if they contain at least one mapping
+			{
+				Scope *scope = element->value;
+
+				return scope->length != 0;
+			};
+			break;
+	}
+
+	// all Elements of any other type are considered truthy
+	return true;
+}
+
+// pool that all Closures are allocated from
+Pool closure_pool = POOL_OF(Closure);
+
+// function to make and initialise a new Closure object
+Closure *Closure_new(Element *expression, Element *variable, Element *scopes, Instruction *code) {
+	Closure *new_closure = Pool_alloc(&closure_pool);
+	new_closure->expression = expression;
+	new_closure->variable = variable;
+	new_closure->scopes = scopes;
+	new_closure->code = code;
+	return new_closure;
+}
+
+// function to make and initialise a new Heap object
+Heap *Heap_new(size_t budget, double growth) {
+	Heap *new_heap = malloc(sizeof(Heap));
+	new_heap->young = Stack_new();
+	new_heap->old = Stack_new();
+	new_heap->remembered = Stack_new();
+	new_heap->threshold = budget;
+	new_heap->budget = budget;
+	new_heap->growth = growth;
+	new_heap->minor_collections = 0;
+	new_heap->major_collections = 0;
+	new_heap->allocated = 0;
+	new_heap->promoted = 0;
+	new_heap->freed = 0;
+	new_heap->peak = 0;
+	return new_heap;
+}
+
+// function that adds a new element to the heap so that it can be garbage collected later
+Element *add_to_heap(Element *new_element, Heap *heap) {
+	heap->young = Stack_push(heap->young, new_element);
+
+	heap->allocated++;
+	if (heap->young->length + heap->old->length > heap->peak) {
+		heap->peak = heap->young->length + heap->old->length;
+	}
+
+	return new_element;
+}
+
+// function that makes a new element with a specific type and value, and adds it to the heap so that it can be garbage collected later
+Element *make(ElementType type, void *value, Heap *heap) {
+	return add_to_heap(Element_new(type, value), heap);
+}
+
+// pool that all number Elements are allocated from
+Pool number_element_pool = POOL_OF(NumberElement);
+
+// number Elements for the shared integers, which are filled in when they are first used
+// they are marked as permanently non-garbage and are never added to a heap, just like the syntax tree
+NumberElement small_numbers[SMALL_NUMBER_MAX - SMALL_NUMBER_MIN + 1];
+
+// function that makes a new number Element with a specific value
+// Numbers are never changed after they are made, so small integers can safely reuse a shared Element without touching the heap at all
+Element *make_number(Number number, Heap *heap) {
+	if (!number.is_double && number.value_long >= SMALL_NUMBER_MIN && number.value_long <= SMALL_NUMBER_MAX) {
+		NumberElement *small_number = &small_numbers[number.value_long - SMALL_NUMBER_MIN];
+
+		// fill in the shared Element the first time that it is used
+		if (small_number->element.value == NULL) {
+			small_number->number = number;
+			small_number->element.type = ELEMENT_NUMBER;
+			small_number->element.gc_checked = true;
+			small_number->element.value = &small_number->number;
+		}
+
+		return &small_number->element;
+	}
+
+	NumberElement *new_number = Pool_alloc(&number_element_pool);
+	new_number->number = number;
+	new_number->element.type = ELEMENT_NUMBER;
+	new_number->element.gc_checked = false;
+	new_number->element.gc_old = false;
+	new_number->element.gc_remembered = false;
+	new_number->element.value = &new_number->number;
+
+	return add_to_heap(&new_number->element, heap);
+}
+
+// function that must be called whenever an Element is changed to refer to another Element
+// a minor garbage collection does not trace through old Elements, so any old Element that might now refer to a young Element has to be remembered until the next garbage collection
+void write_barrier(Element *element, Heap *heap) {
+	if (element->gc_old && !element->gc_remembered) {
+		element->gc_remembered = true;
+		heap->remembered = Stack_push(heap->remembered, element);
+	}
+}
+
+// function to recursively mark items as non-garbage so that the garbage collector doesn't destroy useful data
+void garbage_check(Element *element) {
+	// stop the recursion if a valid element isn't provided or if the element has been visited already
+	if (element == NULL || element->gc_checked) {
+		return;
+	}
+
+	// mark the element as non-garbabge
+	element->gc_checked = true;
+
+	switch (element->type) {
+		case ELEMENT_OPERATION:
+			{
+				Operation *operation = element->value;
+				garbage_check(operation->element_a);
+				garbage_check(operation->element_b);
+			};
+			break;
+		case ELEMENT_SEQUENCE:
+			{
+				Stack *sequence = element->value;
+
+				// iterate through all statements in the sequence
+				for (size_t y = 0; y < sequence->length; y++) {
+					Stack *statement = sequence->content[y];
+
+					// iterate through all Elements in the statement
+					for (size_t x = 0; x < statement->length; x++) {
+						garbage_check(statement->content[x]);
+					}
+				}
+			};
+			break;
+		case ELEMENT_SCOPE:
+			{
+				Scope *scope = element->value;
+
+				// the Scope that this Scope was made in can still be used to look up variables
+				garbage_check(scope->parent);
+
+				// iterate through all the Maps in the Scope and check the keys and values
+				for (size_t i = 0; i < scope->used; i++) {
+					if (scope->maps[i].key == NULL) {
+						continue;
+					}
+
+					garbage_check(scope->maps[i].key);
+					garbage_check(scope->maps[i].value);
+				}
+			};
+			break;
+		case ELEMENT_CLOSURE:
+			{
+				Closure *closure = element->value;
+				garbage_check(closure->expression);
+				garbage_check(closure->variable);
+				garbage_check(closure->scopes);
+			};
+			break;
+	}
+}
+
+// function to free an element and its contents
+void nuke(Element *element) {
+	switch (element->type) {
+		case ELEMENT_NULL:
+		case ELEMENT_BRACKET:
+		case ELEMENT_BRACE:
+		case ELEMENT_COMMAND:
+			break;
+
+		case ELEMENT_SEQUENCE:
+			{
+				Stack *sequence = element->value;
+
+				// free all the statements in the sequence
+				for (size_t y = 0; y < sequence->length; y++) {
+					free(sequence->content[y]);
+				}
+
+				// free the sequence itself
+				free(sequence);
+			};
+			break;
+
+		case ELEMENT_SCOPE:
+			// Scopes have their list of mappings and their hash index stored separately
+			Scope_free(element->value);
+			break;
+
+		case ELEMENT_NUMBER:
+			// number Elements store their Number in the same allocation, so they are given back to their pool as a whole
+			Pool_free(&number_element_pool, element);
+			return;
+
+		// these values are given back to the pools they were allocated from
+		case ELEMENT_OPERATION:
+			Pool_free(&operation_pool, element->value);
+			break;
+
+		case ELEMENT_CLOSURE:
+			Pool_free(&closure_pool, element->value);
+			break;
+
+		case ELEMENT_VARIABLE:
+		case ELEMENT_STRING:
+			// Strings might share the memory for their characters with other Strings
+			String_free(element->value);
+			break;
+
+		default:
+			// most elements only need their value free'd
+			free(element->value);
+	}
+
+	// free the element itself
+	Pool_free(&element_pool, element);
+}
+
+// function to mark the roots of a garbage collection as non-garbage
+void garbage_check_roots(Element *result, Stack **keep_stack, Stack **scopes_stack) {
+	if (result != NULL) {
+		// mark any single result value as non-garbage
+		garbage_check(result);
+	}
+
+	if (scopes_stack != NULL) {
+		// mark all the items in scopes as non-garbage
+		for (size_t i = 0; i < (*scopes_stack)->length; i++) {
+			garbage_check((*scopes_stack)->content[i]);
+		}
+	}
+
+	if (keep_stack != NULL) {
+		// mark all the items in the keep stack as non-garbage
+		for (size_t i = 0; i < (*keep_stack)->length; i++) {
+			garbage_check((*keep_stack)->content[i]);
+		}
+	}
+}
+
+// function to free the unmarked Elements of the young generation and move the rest to the old generation
+void sweep_young_generation(Heap *heap) {
+	// make room for every young Element to survive up front, so that the old generation is grown at most once
+	heap->old = Stack_reserve(heap->old, heap->old->length + heap->young->length);
+
+	for (size_t i = 0; i < heap->young->length; i++) {
+		Element *element = heap->young->content[i];
+
+		if (element->gc_checked) {
+			// survivors stay marked as non-garbage once they are in the old generation
+			element->gc_old = true;
+			heap->old = Stack_push(heap->old, element);
+			heap->promoted++;
+		} else {
+			nuke(element);
+			heap->freed++;
+		}
+	}
+
+	heap->young = Stack_truncate(heap->young, 0);
+}
+
+// function to clean out the unreferenced garbage in the young generation without tracing through the old generation
+void garbage_collect_minor(Element *result, Stack **keep_stack, Stack **scopes_stack, Heap *heap) {
+	// trace through every old Element that has been changed since the last garbage collection, since they might refer to young Elements
+	for (size_t i = 0; i < heap->remembered->length; i++) {
+		Element *element = heap->remembered->content[i];
+		element->gc_remembered = false;
+
+		// unmark the old Element for a moment so that it is traced through again
+		element->gc_checked = false;
+		garbage_check(element);
+	}
+	heap->remembered = Stack_truncate(heap->remembered, 0);
+
+	garbage_check_roots(result, keep_stack, scopes_stack);
+
+	sweep_young_generation(heap);
+
+	heap->minor_collections++;
+}
+
+// function to clean out any unreferenced garbage that has been building up on the heap tracker, including the old generation
+void garbage_collect(Element *result, Stack **keep_stack, Stack **scopes_stack, Heap *heap) {
+	// the whole heap is traced through, so there is no need to remember any changed Elements
+	for (size_t i = 0; i < heap->remembered->length; i++) {
+		((Element*)heap->remembered->content[i])->gc_remembered = false;
+	}
+	heap->remembered = Stack_truncate(heap->remembered, 0);
+
+	// re-mark the old generation as potential garbage
+	for (size_t i = 0; i < heap->old->length; i++) {
+		((Element*)heap->old->content[i])->gc_checked = false;
+	}
+
+	garbage_check_roots(result, keep_stack, scopes_stack);
+
+	// the number of Elements that have survived so far, which is also the position in the heap tracker to move the next survivor to
+	size_t kept = 0;
+
+	// iterate through all the Elements in the old generation
+	for (size_t i = 0; i < heap->old->length; i++) {
+		Element *element = heap->old->content[i];
+
+		if (element->gc_checked) {
+			// move the survivor down to fill any gaps left by the garbage before it
+			heap->old->content[kept] = element;
+			kept++;
+		} else {
+			// if any Element is found that has not been marked as non-garbage, free it
+			nuke(element);
+			heap->freed++;
+		}
+	}
+
+	// remove the space left over by the garbage from the end of the heap tracker in one go
+	heap->old = Stack_truncate(heap->old, kept);
+
+	sweep_young_generation(heap);
+
+	heap->major_collections++;
+
+	// allow the old generation to grow in proportion to the amount of live data before tracing through it again, so that programs with lots of live data don't spend all their time marking it
+	heap->threshold = heap->old->length + heap->budget + (size_t)(heap->old->length * heap->growth);
+}
+
+// function to free a Heap object along with every Element that is still on it
+void Heap_free(Heap *heap) {
+	for (size_t i = 0; i < heap->young->length; i++) {
+		nuke(heap->young->content[i]);
+	}
+
+	for (size_t i = 0; i < heap->old->length; i++) {
+		nuke(heap->old->content[i]);
+	}
+
+	free(heap->young);
+	free(heap->old);
+	free(heap->remembered);
+	free(heap);
+}
+
+// function to clean out the garbage on the heap tracker only if enough new Elements have been made since the last garbage collection
+// the old generation is only traced through once it has grown past its threshold
+void garbage_collect_if_due(Element *result, Stack **keep_stack, Stack **scopes_stack, Heap *heap) {
+	if (heap->young->length < heap->budget) {
+		return;
+	}
+
+	if (heap->old->length >= heap->threshold) {
+		garbage_collect(result, keep_stack, scopes_stack, heap);
+	} else {
+		garbage_collect_minor(result, keep_stack, scopes_stack, heap);
+	}
+}
+
+// function to set a variable in any of the scopes available in the current evaluation, starting from the innermost Scope
+// the local_only parameter forces the variable to be set only in the local scope
+void set_variable(Element *key, Element *value, Element *scopes, bool local_only, Heap *heap) {
+	if (key->type == ELEMENT_NULL) {
+		return;
+	}
+
+	// if the local_only parameter is set, consider only the most recent scope
+	Element *scope = scopes;
+
+	if (!local_only) {
+		// search through all scopes from youngest to oldest until a scope is found
+		// if no scope has the key, the oldest scope is used
+		while (!check_scope_mapping(scope->value, key) && ((Scope*)scope->value)->parent != NULL) {
+			scope = ((Scope*)scope->value)->parent;
+		}
+	}
+
+	// modify the appropriate scope according to the key and value specified
+	scope->value = set_scope_mapping(scope->value, key, value);
+	write_barrier(scope, heap);
+}
+
+// function to edit the mapping within a Scope for a 'mut' or 'edit' statement, which can add any key to any Scope
+void set_scope_mapping_dynamically(Element *scope, Element *key, Element *value, Heap *heap) {
+	size_t length = ((Scope*)scope->value)->length;
+
+	scope->value = set_scope_mapping(scope->value, key, value);
+	write_barrier(scope, heap);
+
+	// if a new key was added, the Scope no longer only has the variables defined by its own sequence
+	if (((Scope*)scope->value)->length != length) {
+		((Scope*)scope->value)->changed_dynamically = true;
+	}
+}
+
+// function to retrieve the value of a variable in any of the scopes available in the current evaluation, starting from the innermost Scope
+Element *get_variable(Element *key, Element *scopes) {
+	// iterate through all scopes from the youngest to the oldest
+	for (Element *scope_element = scopes; scope_element != NULL; scope_element = ((Scope*)scope_element->value)->parent) {
+		// retrieve a potential value from the Scope
+		Element *result = get_scope_mapping(scope_element->value, key);
+
+		// if a value for the key was found in this scope, return it
+		if (result != NULL) {
+			return result;
+		}
+	}
+
+	// if no value was found, print the variable name and an error message
+	putchar('\n');
+	print_value(key, 0, true);
+	whoops("variable not found");
+
+	return NULL;
+}
+
+// function to get the innermost Scope in which the expression of a Closure is evaluated when it is applied to an argument
+Element *prepare_closure_scopes(Closure *closure, Element *argument, Heap *heap) {
+	// if no variable name has been set, the expression is evaluated directly in the Scope that the Closure was made in
+	if (closure->variable == NULL) {
+		return closure->scopes;
+	}
+
+	// otherwise, make a new scope containing the variable and its value inside the Scope that the Closure was made in
+	Element *scope = make(ELEMENT_SCOPE, Scope_new(closure->scopes), heap);
+
+	scope->value = set_scope_mapping(scope->value, closure->variable, argument);
+
+	return scope;
+}
+
+// function to perform an operation on two values once both operands have been evaluated
+// this is used for every operation that always evaluates both of its operands, regardless of how they are evaluated
+Element *perform_operation(OperationType operation_type, Element *element_a, Element *element_b, Heap *heap) {
+	switch (operation_type) {
+		case OPERATION_EQUALITY:
+		case OPERATION_INEQUALITY:
+			{
+				// create a new number for the result
+				Number number = {0};
+
+				// check if the two elements are equal or not
+				bool result = compare_elements(element_a, element_b);
+
+				// if we are checking for inequality, invert the result
+				if (operation_type == OPERATION_INEQUALITY) {
+					result = !result;
+				}
+
+				// set the number value to either 1 (true) or 0 (false) depending on the result
+				number.value_long = result ? 1 : 0;
+
+				// make a new Number Element containing the new number
+				return make_number(number, heap);
+			};
+			break;
+
+		case OPERATION_ADDITION:
+		case OPERATION_SUBTRACTION:
+		case OPERATION_MULTIPLICATION:
+		case OPERATION_DIVISION:
+		case OPERATION_REMAINDER:
+		case OPERATION_POW:
+		case OPERATION_LT:
+		case OPERATION_GT:
+		case OPERATION_LTE:
+		case OPERATION_GTE:
+			{
+				// throw an error if either one is not a number
+				if (element_a->type != ELEMENT_NUMBER || element_b->type != ELEMENT_NUMBER) {
+					whoops("numeric operations can only be applied to numeric values");
+				}
+
+				// operate on the numbers and return a new Number Element containing the result
+				return make_number(perform_numeric_operation(operation_type, element_a->value, element_b->value), heap);
+			};
+			break;
+
+		case OPERATION_SHIFT_LEFT:
+		case OPERATION_SHIFT_RIGHT:
+		case OPERATION_BWAND:
+		case OPERATION_BWOR:
+		case OPERATION_BWXOR:
+			{
+				if (element_a->type != ELEMENT_NUMBER || element_b->type != ELEMENT_NUMBER) {
+					whoops("bitwise operations may only be applied to integers");
+				}
+
+				Number *number_a = element_a->value;
+				Number *number_b = element_b->value;
+
+				if (number_a->is_double || number_b->is_double) {
+					whoops("bitwise operations may only be applied to integers");
+				}
+
+				// make a new number to store the result
+				Number result = {0};
+
+				// perform the appropriate bitwise operation
+				switch (operation_type) {
+					case OPERATION_SHIFT_LEFT:
+						result.value_long = number_a->value_long << number_b->value_long;
+						break;
+					case OPERATION_SHIFT_RIGHT:
+						result.value_long = number_a->value_long >> number_b->value_long;
+						break;
+					case OPERATION_BWAND:
+						result.value_long = number_a->value_long & number_b->value_long;
+						break;
+					case OPERATION_BWOR:
+						result.value_long = number_a->value_long | number_b->value_long;
+						break;
+					case OPERATION_BWXOR:
+						result.value_long = number_a->value_long ^ number_b->value_long;
+						break;
+				}
+
+				// make a new Element to store the result and return it
+				return make_number(result, heap);
+			};
+			break;
+
+		case OPERATION_SUBL:
+		case OPERATION_SUBG:
+			{
+				// make sure that the types line up for this operation
+				if (element_a->type != ELEMENT_STRING || element_b->type != ELEMENT_NUMBER) {
+					whoops("substring operations must be applied to a string and a non-negative integer");
+				}
+
+				String *string = element_a->value;
+				Number *slice_index = element_b->value;
+
+				// ensure that the number supplied is not a negative number or a floating-point value, since these kinds of values are not easily applicable to string slicing
+				if (slice_index->is_double || slice_index->value_long < 0) {
+					whoops("substring operations must be applied to a string and a non-negative integer");
+				}
+
+				// figure out the length of the new string
+				// for SUBL, this will either be the length of the string or the slice index, whichever is smaller
+				// for SUBG, this will either be the subtraction of the slice index from the length or zero if the slice index is bigger than the length
+				size_t length;
+				if (operation_type == OPERATION_SUBL) {
+					if (slice_index->value_long >= string->length) {
+						length = string->length;
+					} else {
+						length = slice_index->value_long;
+					}
+				} else {
+					if (slice_index->value_long >= string->length) {
+						length = 0;
+					} else {
+						length = string->length - slice_index->value_long;
+					}
+				}
+
+				// the new string shares its characters with the old string where it makes sense, so taking the substring doesn't need to copy anything
+				String *result = String_slice(string, operation_type == OPERATION_SUBL ? 0 : string->length - length, length);
+
+				// make a new Element to store the result and return it
+				return make(ELEMENT_STRING, result, heap);
+			};
+			break;
+
+		case OPERATION_CHAR_AT:
+			{
+				// both Elements must be of an acceptable type
+				if (element_a->type != ELEMENT_STRING || element_b->type != ELEMENT_NUMBER) {
+					whoops("character value operator must be applied to a string and an integer, in that order");
+				}
+
+				Number *index_number = element_b->value;
+
+				// ensure that the Number supplied is, in fact, an integer
+				if (index_number->is_double) {
+					whoops("character value operator only accepts integer values in the second operand");
+				}
+
+				String *subject_string = element_a->value;
+
+				// if the index is out of range, return a Null Element
+				if (index_number->value_long < 0 || index_number->value_long > subject_string->length) {
+					return make(ELEMENT_NULL, NULL, heap);
+				}
+
+				Number result = {0};
+
+				// set the value of the result to the value of the byte at the index specified in the second operand
+				result.value_long = subject_string->content[index_number->value_long];
+
+				return make_number(result, heap);
+			};
+			break;
+
+		case OPERATION_CHAR_APPEND:
+			{
+				// both Elements must be of an acceptable type
+				if (element_a->type != ELEMENT_STRING || element_b->type != ELEMENT_NUMBER) {
+					whoops("character append operator must be applied to a string and an integer, in that order");
+				}
+
+				Number *char_code_number = element_b->value;
+
+				// ensure that the Number supplied is, in fact, an integer
+				if (char_code_number->is_double) {
+					whoops("character append operator only accepts integer values in the second operand");
+				}
+
+				String *subject_string = element_a->value;
+
+				// the new string has an additional byte, with the character value specified by the value of the second operand
+				unsigned char character = char_code_number->value_long;
+				String *result = String_append(subject_string, &character, 1);
+
+				return make(ELEMENT_STRING, result, heap);
+			};
+			break;
+
+		case OPERATION_XOR:
+			{
+				Number result = {0};
+
+				// return a truthy value only if the truthiness of the two evaluations differ
+				result.value_long = value_is_truthy(element_a) != value_is_truthy(element_b) ? 1 : 0;
+
+				// make a new Number Element to store the result and return it
+				return make_number(result, heap);
+			};
+			break;
+
+		case OPERATION_LIKENESS:
+			{
+				// create a new Number to store the result
+				Number result = {0};
+
+				// set the Number element to 1 if the types are equal, otherwise 0
+				result.value_long = element_a->type == element_b->type ? 1 : 0;
+
+				// make a new Number Element to store the result and return it
+				return make_number(result, heap);
+			};
+			break;
+
+		default:
+			// throw an error if the user uses any operators that haven't been defined yet
+			whoops("operator not defined");
+	}
+
+	return NULL;
+}
+
+// function to retrieve the value of a property of a Scope Element, throwing an error if there is no such property
+Element *access_property(Element *subject, Element *property_name) {
+	if (subject->type != ELEMENT_SCOPE) {
+		whoops("property access operation can only have a scope as a subject");
+	}
+
+	// retrieve the value from the scope, if any
+	Element *result = get_scope_mapping(subject->value, property_name);
+	if (result == NULL) {
+		// if no result is found, print the property name and an error message
+		putchar('\n');
+		print_value(property_name, 0, true);
+		whoops("no such property in this scope");
+	}
+
+	return result;
+}
+
+// function to make a new Number Element containing a random floating-point number n such that 0 <= n < 1
+Element *make_random_number(Heap *heap) {
+	// create a new Number to represent the result
+	Number result = {0};
+	result.is_double = true;
+
+	// generate the random number
+	// the maximum random number able to be generated by rand() is RAND_MAX and the minimum is 0
+	// so dividing it by RAND_MAX + 1.0 would return a number n such that 0 <= n < 1
+	float random_number = rand();
+	result.value_double = random_number / (RAND_MAX + 1.0);
+
+	return make_number(result, heap);
+}
+
+// function to make a new Number Element containing the length of a String Element in bytes
+Element *measure_string(Element *subject, Heap *heap) {
+	String *subject_string = subject->value;
+
+	Number result = {0};
+	result.value_long = subject_string->length;
+
+	return make_number(result, heap);
+}
+
+// function to read a line of input from the console and make a new String Element containing it
+Element *read_input(Heap *heap) {
+	// make a temporary buffer to store the input
+	char *buffer = NULL;
+	size_t allocated_length = 0;
+
+	// make sure that any prompt that the script has printed is visible before waiting for the user
+	fflush(stdout);
+
+	// the actual length of the user input will be returned by getline, but we'll subtract one because we don't want the newline character at the end
+	size_t actual_length = getline(&buffer, &allocated_length, stdin) - 1;
+
+	String *result = String_new(actual_length);
+
+	// move the useful data in the buffer to the result string
+	for (size_t i = 0; i < actual_length; i++) {
+		result->content[i] = buffer[i];
+	}
+
+	// we no longer need the temporary buffer so it can be safely free'd
+	free(buffer);
+
+	return make(ELEMENT_STRING, result, heap);
+}
+
+// function to read the file at the location described by a String Element
+// the result is either a String Element containing the file contents or a Null Element if the file cannot be read
+Element *read_file_element(Element *path, Heap *heap) {
+	String *path_string = path->value;
+
+	// make a temporary char array to store the path so that it can be passed to read_file()
+	char path_buffer[path_string->length + 1];
+
+	// copy the string contents to the temporary buffer
+	memcpy(&path_buffer, path_string->content, path_string->length);
+
+	// add a null terminator to the path string
+	path_buffer[path_string->length] = '\0';
+
+	// read the file
+	String *result_string = read_file(path_buffer);
+
+	// if the file contents can be read, make a String element and store them in it
+	// otherwise, the result will be a Null Element
+	if (result_string == NULL) {
+		return make(ELEMENT_NULL, NULL, heap);
+	}
+
+	return make(ELEMENT_STRING, result_string, heap);
+}
+
+// function to write the contents of a String Element to the file at the location described by another String Element
+// the result is a Number Element that is 1 if the file was successfully written and 0 otherwise
+Element *write_file_element(Element *new_contents, Element *path, Heap *heap) {
+	String *path_string = path->value;
+
+	// make a temporary char array to store the path so that it can be passed to write_file()
+	char path_buffer[path_string->length + 1];
+
+	// copy the string contents to the temporary buffer
+	memcpy(&path_buffer, path_string->content, path_string->length);
+
+	// add a null terminator to the path string
+	path_buffer[path_string->length] = '\0';
+
+	// create a new Number to represent the result
+	Number result = {0};
+
+	// attempt to write the new contents to the file and update the result number's value accordingly
+	result.value_long = write_file(path_buffer, new_contents->value) ? 1 : 0;
+
+	return make_number(result, heap);
+}
+
+// function to perform an operation on two elements after they have been juxtaposed
+Element *juxtapose(Element *element_a, Element *element_b, Stack **keep_stack, Stack **scopes_stack, Heap *heap) {
+	switch (element_a->type) {
+		case ELEMENT_SCOPE:
+			// application of a Scope to any value finds the value associated with the key described by the value to which the Scope is applied
+			{
+				Element *result = get_scope_mapping(element_a->value, element_b);
+				if (result == NULL) {
+					result = make(ELEMENT_NULL, NULL, heap);
+				}
+				return result;
+			};
+			break;
+
+		case ELEMENT_CLOSURE:
+			// application of a Closure to any value calls the Closure with the value
+			{
+				Closure *closure = element_a->value;
+
+				// get the innermost Scope in which the Closure's expression will be evaluated
+				Element *closure_scopes = prepare_closure_scopes(closure, element_b, heap);
+
+				// add the innermost Scope to the Scope stack
+				*scopes_stack = Stack_push(*scopes_stack, closure_scopes);
+
+				// add the closure to the keep stack so that it isn't garbage collected mid-call
+				*keep_stack = Stack_push(*keep_stack, element_a);
+
+				// evaluate the Closure expression with its new innermost Scope
+				Element *tail_function = NULL;
+				Element *tail_argument = NULL;
+				Element *result = evaluate_tail(closure->expression, keep_stack, scopes_stack, heap, &tail_function, &tail_argument);
+
+				// if the Closure ended by applying another Closure, make that call in place of this one so that calls in tail position don't use up any more memory
+				while (result == NULL && tail_function->type == ELEMENT_CLOSURE) {
+					closure = tail_function->value;
+
+					(*scopes_stack)->content[(*scopes_stack)->length - 1] = prepare_closure_scopes(closure, tail_argument, heap);
+					(*keep_stack)->content[(*keep_stack)->length - 1] = tail_function;
+
+					result = evaluate_tail(closure->expression, keep_stack, scopes_stack, heap, &tail_function, &tail_argument);
+				}
+
+				// any other application in tail position is made as usual
+				if (result == NULL) {
+					result = juxtapose(tail_function, tail_argument, keep_stack, scopes_stack, heap);
+				}
+
+				// remove the innermost Scope of the call from the Scope stack so the previous innermost Scope is restored
+				*scopes_stack = Stack_pop(*scopes_stack);
+
+				// the call has ended so it's safe to remove the Closure from the keep stack
+				*keep_stack = Stack_pop(*keep_stack);
+
+				return result;
+			};
+			break;
+
+		case ELEMENT_STRING:
+			// application of a string to a string concatenates the strings
+			{
+				if (element_b->type != ELEMENT_STRING) {
+					whoops("string concatenation can only be applied to strings");
+				}
+
+				String *string_a = element_a->value;
+				String *string_b = element_b->value;
+
+				// add the characters of the second string to the end of the first string
+				// this usually doesn't need to copy the first string, so building up a string bit by bit is fast
+				String *result = String_append(string_a, string_b->content, string_b->length);
+
+				// make a new Element for the result string and return it
+				return make(ELEMENT_STRING, result, heap);
+			};
+			break;
+
+		case ELEMENT_NULL:
+			return element_a;
+
+		default:
+			printf("%d", element_a->type);
+			whoops("cannot apply this type to any value");
+	}
+
+	return NULL;
+}
+
+// function to evaluate a branch of the abstract syntax tree
+Element *evaluate(Element *branch, Stack **keep_stack, Stack **scopes_stack, Heap *heap) {
+	return evaluate_tail(branch, keep_stack, scopes_stack, heap, NULL, NULL);
+}
+
+// function to evaluate a branch of the abstract syntax tree that is in tail position within a Closure call
+// if tail_function is not NULL and the branch ends with an application, the application is not made and NULL is returned, leaving its operands in tail_function and tail_argument for the caller to apply
+Element *evaluate_tail(Element *branch, Stack **keep_stack, Stack **scopes_stack, Heap *heap, Element **tail_function, Element **tail_argument) {
+	// get the innermost Scope of the current Closure call from the Scope stack
+	Element *scopes = (*scopes_stack)->content[(*scopes_stack)->length - 1];
+
+	switch (branch->type) {
+		case ELEMENT_SEQUENCE:
+			{
+				// each sequence should have its own local scope, which becomes the innermost Scope until the sequence ends
+				Element *parent = scopes;
+				Element *scope = make(ELEMENT_SCOPE, Scope_new(parent), heap);
+				scopes = scope;
+				(*scopes_stack)->content[(*scopes_stack)->length - 1] = scopes;
+
+				Stack *sequence = branch->value;
+
+				// iterate through each statement in the sequence
+				for (size_t statement_index = 0; statement_index < sequence->length; statement_index++) {
+					Stack *statement = sequence->content[statement_index];
+
+					// get the command, which was resolved from the first element in the statement when the syntax tree was constructed
+					Element *command = statement->content[0];
+
+					switch ((CommandType)(uintptr_t)command->value) {
+						case COMMAND_DO:
+							{
+								// iterate through each argument and evaluate it
+								for (size_t i = 1; i < statement->length; i++) {
+									evaluate(statement->content[i], keep_stack, scopes_stack, heap);
+								}
+							};
+							break;
+
+						case COMMAND_RETURN:
+							{
+								if (statement->length != 2) {
+									whoops("'return' statement requires exactly 1 argument");
+								}
+
+								// evaluate the single expression to determine the result, which is in tail position if this Sequence is
+								Element *result = evaluate_tail(statement->content[1], keep_stack, scopes_stack, heap, tail_function, tail_argument);
+
+								// restore the Scope that the current Sequence was evaluated in as the innermost Scope
+								(*scopes_stack)->content[(*scopes_stack)->length - 1] = parent;
+
+								return result;
+							};
+							break;
+
+						case COMMAND_PRINT:
+							{
+								for (size_t i = 1; i < statement->length; i++) {
+									// print the evaluated values, and print only the contents of strings
+									print_value(evaluate(statement->content[i], keep_stack, scopes_stack, heap), 0, false);
+								}
+							};
+							break;
+
+						case COMMAND_SHOW:
+							{
+								for (size_t i = 1; i < statement->length; i++) {
+									// print the evaluated values, and format the strings as code
+									print_value(evaluate(statement->content[i], keep_stack, scopes_stack, heap), 0, true);
+								}
+							};
+							break;
+
+						case COMMAND_WHOOPS:
+							{
+								for (size_t i = 1; i < statement->length; i++) {
+									// print the evaluated values, and print only the contents of strings
+									print_value(evaluate(statement->content[i], keep_stack, scopes_stack, heap), 0, false);
+								}
+
+								// throw an error and exit the code
+								whoops("user-defined error");
+							};
+							break;
+
+						case COMMAND_RAND:
+							{
+								if (statement->length != 2) {
+									whoops("'rand' statement requires exactly 1 argument");
+								}
+
+								Element *key = statement->content[1];
+
+								// make a new Element containing the new random number and store it in the variable specified
+								set_variable(key, make_random_number(heap), scopes, true, heap);
+							};
+							break;
+
+						case COMMAND_LENGTH:
+							{
+								if (statement->length != 3) {
+									whoops("'length' statement requires exactly 2 arguments");
+								}
+
+								Element *key = statement->content[1];
+
+								// evaluate the subject argument
+								Element *subject = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+								if (subject->type != ELEMENT_STRING) {
+									whoops("'length' command requires the second argument to be a string");
+								}
+
+								// make a new Number Element for the result and assign it to the variable
+								set_variable(key, measure_string(subject, heap), scopes, true, heap);
+							};
+							break;
+
+						case COMMAND_INPUT:
+							{
+								if (statement->length != 2) {
+									whoops("'input' statement requires exactly 1 argument");
+								}
+
+								Element *key = statement->content[1];
+
+								// make a new String Element for the result and assign it to the variable
+								set_variable(key, read_input(heap), scopes, true, heap);
+							};
+							break;
+
+						case COMMAND_READFILE:
+							{
+								if (statement->length != 3) {
+									whoops("'readfile' command requires exactly 2 arguments");
+								}
+
+								Element *key = statement->content[1];
+
+								// evaluate the path argument
+								Element *path = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+								if (path->type != ELEMENT_STRING) {
+									whoops("'readfile' command requires the second argument to be a valid filepath string");
+								}
+
+								// read the file and assign either its contents or a Null Element to the variable
+								set_variable(key, read_file_element(path, heap), scopes, true, heap);
+							};
+							break;
+
+						case COMMAND_WRITEFILE:
+							{
+								if (statement->length != 4) {
+									whoops("'writefile' command requires exactly 3 arguments");
+								}
+
+								Element *key = statement->content[1];
+
+								// evaluate the new contents for the file
+								Element *new_contents = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+								if (new_contents->type != ELEMENT_STRING) {
+									whoops("'writefile' command requires the first argument to be a string");
+								}
+
+								*keep_stack = Stack_push(*keep_stack, new_contents);
+
+								// evaluate the path argument
+								Element *path = evaluate(statement->content[3], keep_stack, scopes_stack, heap);
+								if (path->type != ELEMENT_STRING) {
+									whoops("'writefile' command requires the second argument to be a filepath string");
+								}
+
+								// attempt to write the new contents to the file
+								Element *result = write_file_element(new_contents, path, heap);
+
+								*keep_stack = Stack_pop(*keep_stack);
+
+								// update the variable to reflect the writing operation's verdict by setting it to a new Number Element representing said verdict
+								set_variable(key, result, scopes, true, heap);
+							};
+							break;
+
+						case COMMAND_IF:
+							{
+								if (statement->length < 3) {
+									whoops("'if' statement requires at least 2 arguments");
+								}
+
+								bool result = false;
+
+								// iterate through each condition-action pair and perform only the first action that is associated with a condition that evaluates to a truthy value
+								// if there is a trailing value that does not belong to a pair, execute it if no condition is acceptable
+								for (size_t i = 1; i < statement->length && !result; i += 2) {
+									if (i + 1 == statement->length) {
+										// if this is the last argument, evaluate it as an action, since no condition was acceptable
+										evaluate(statement->content[i], keep_stack, scopes_stack, heap);
+									} else if (value_is_truthy(evaluate(statement->content[i], keep_stack, scopes_stack, heap))) {
+										// if there is a condition and it evaluates to a truthy value, evaluate it and cease further evaluations
+
+										result = true;
+										evaluate(statement->content[i + 1], keep_stack, scopes_stack, heap);
+									}
+								}
+							};
+							break;
+
+						case COMMAND_WHILE:
+							{
+								if (statement->length != 3) {
+									whoops("'while' statement requires exactly 2 arguments");
+								}
+
+								// evaluate the condition and check if it's a truthy value before iterating
+								while (value_is_truthy(evaluate(statement->content[1], keep_stack, scopes_stack, heap))) {
+									// evaluate the action
+									evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+
+									// perform early garbage collection to avoid memory leaks within long loops
+									garbage_collect_if_due(NULL, keep_stack, scopes_stack, heap);
+								}
+							};
+							break;
+
+						case COMMAND_LET:
+							{
+								if (statement->length != 3) {
+									whoops("'let' statement requires exactly 2 arguments");
+								}
+
+								Element *key = statement->content[1];
+
+								// evaluate the second argument to find the value to which the variable should be assigned
+								Element *value = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+
+								// update the relevant scope with the new mapping
+								set_variable(key, value, scopes, true, heap);
+							};
+							break;
+
+						case COMMAND_SET:
+							{
+								if (statement->length != 3) {
+									whoops("'set' statement requires exactly 2 arguments");
+								}
+
+								Element *key = statement->content[1];
+
+								// evaluate the second argument to find the value to which the variable should be assigned
+								Element *value = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+
+								// update the relevant scope with the new mapping
+								set_variable(key, value, scopes, false, heap);
+							};
+							break;
+
+						case COMMAND_MUT:
+							{
+								if (statement->length != 4) {
+									whoops("'mut' statement requires exactly 3 arguments");
+								}
+
+								// evaluate the first argument to find the subject
+								Element *subject = evaluate(statement->content[1], keep_stack, scopes_stack, heap);
+
+								if (subject->type != ELEMENT_SCOPE) {
+									whoops("'mut' statement requires a scope object as the first argument");
+								}
+
+								// evaluate the second argument to find the key
+								Element *key = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+
+								*keep_stack = Stack_push(*keep_stack, key);
+
+								// evaluate the third argument to find the value
+								Element *value = evaluate(statement->content[3], keep_stack, scopes_stack, heap);
+
+								// update the Scope with the new mapping
+								set_scope_mapping_dynamically(subject, key, value, heap);
+
+								*keep_stack = Stack_pop(*keep_stack);
+							};
+							break;
+
+						case COMMAND_UNMAP:
+							{
+								if (statement->length != 3) {
+									whoops("'unmap' statement requires exactly 2 arguments");
+								}
+
+								// evaluate the first argument to find the subject
+								Element *subject = evaluate(statement->content[1], keep_stack, scopes_stack, heap);
+								if (subject->type != ELEMENT_SCOPE) {
+									whoops("'unmap' statement requires a scope object as the first argument");
+								}
+
+								// evaluate the second argument to find the key
+								Element *key = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+
+								// delete the appropriate mapping from the Scope
+								subject->value = delete_scope_mapping(subject->value, key);
+							};
+							break;
+
+						case COMMAND_EDIT:
+							{
+								if (statement->length != 4) {
+									whoops("'edit' statement requires exactly 3 arguments");
+								}
+
+								// evaluate the first argument to find the subject
+								Element *subject = evaluate(statement->content[1], keep_stack, scopes_stack, heap);
+								if (subject->type != ELEMENT_SCOPE) {
+									whoops("'edit' statement requires a scope object as the first argument");
+								}
+
+								Element *property_name = statement->content[2];
+
+								// evaluate the third argument to find the value
+								Element *value = evaluate(statement->content[3], keep_stack, scopes_stack, heap);
+
+								// update the Scope with the new mapping
+								set_scope_mapping_dynamically(subject, property_name, value, heap);
+							};
+							break;
+
+						case COMMAND_DELETE:
+							{
+								if (statement->length != 3) {
+									whoops("'delete' statement requires exactly 2 arguments");
+								}
+
+								// evaluate the first argument to find the subject
+								Element *subject = evaluate(statement->content[1], keep_stack, scopes_stack, heap);
+								if (subject->type != ELEMENT_SCOPE) {
+									whoops("'delete' statement requires a scope object as the first argument");
+								}
+
+								// evaluate the second argument to find the key
+								Element *property_name = statement->content[2];
+
+								// delete the appropriate mapping from the Scope
+								subject->value = delete_scope_mapping(subject->value, property_name);
+							};
+							break;
+
+						case COMMAND_KEYS:
+							{
+								if (statement->length != 3) {
+									whoops("'keys' statement requires exactly 2 arguments");
+								}
+
+								// evaluate the first operand and reject it if it is not a Scope
+								Element *subject = evaluate(statement->content[1], keep_stack, scopes_stack, heap);
+								if (subject->type != ELEMENT_SCOPE) {
+									whoops("'keys' statement only accepts a scope as the first argument");
+								}
+
+								*keep_stack = Stack_push(*keep_stack, subject);
+
+								// evaluate the second operand and reject it if it is not a Closure
+								Element *closure = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+								if (closure->type != ELEMENT_CLOSURE) {
+									whoops("'keys' statement only accepts a closure as its second argument");
+								}
+
+								Scope *scope = subject->value;
+
+								// iterate through each mapping in the Scope
+								for (size_t i = 0; i < scope->used; i++) {
+									// skip over the gaps left by deleted mappings
+									if (scope->maps[i].key == NULL) {
+										continue;
+									}
+
+									// retrieve the key of this mapping
+									Element *key = scope->maps[i].key;
+
+									// if the key is not a property name, apply it to the function by virtually juxtaposing the two
+									if (key->type != ELEMENT_VARIABLE) {
+										juxtapose(closure, key, keep_stack, scopes_stack, heap);
+									}
+								}
+
+								*keep_stack = Stack_pop(*keep_stack);
+							};
+							break;
+
+						case COMMAND_VALUES:
+							{
+								if (statement->length != 3) {
+									whoops("'values' statement requires exactly 2 arguments");
+								}
+
+								// evaluate the first operand and reject it if it is not a Scope
+								Element *subject = evaluate(statement->content[1], keep_stack, scopes_stack, heap);
+								if (subject->type != ELEMENT_SCOPE) {
+									whoops("'values' statement only accepts a scope as the first argument");
+								}
+
+								*keep_stack = Stack_push(*keep_stack, subject);
+
+								// evaluate the second operand and reject it if it is not a Closure
+								Element *closure = evaluate(statement->content[2], keep_stack, scopes_stack, heap);
+								if (closure->type != ELEMENT_CLOSURE) {
+									whoops("'values' statement only accepts a closure as its second argument");
+								}
+
+								Scope *scope = subject->value;
+
+								// iterate through each mapping in the Scope
+								for (size_t i = 0; i < scope->used; i++) {
+									// skip over the gaps left by deleted mappings
+									if (scope->maps[i].key == NULL) {
+										continue;
+									}
+
+									// retrieve the key of this mapping
+									Element *key = scope->maps[i].value;
+
+									// if the key is not a property name, apply it to the function by virtually juxtaposing the two
+									if (key->type != ELEMENT_VARIABLE) {
+										juxtapose(closure, key, keep_stack, scopes_stack, heap);
+									}
+								}
+
+								*keep_stack = Stack_pop(*keep_stack);
+							};
+							break;
+					}
+
+					// collect any garbage that may have accumulated over the course of the execution of this statement
+					garbage_collect_if_due(NULL, keep_stack, scopes_stack, heap);
+				}
+
+				// restore the Scope that the current Sequence was evaluated in as the innermost Scope
+				(*scopes_stack)->content[(*scopes_stack)->length - 1] = parent;
+
+				// if no value was returned by the sequence, return its own scope
+				return scope;
+			};
+			break;
+
+		case ELEMENT_VARIABLE:
+			// if it's a variable name, return its value
+			return get_variable(branch, scopes);
+
+		case ELEMENT_OPERATION:
+			// handle the behaviours of each operation
+			{
+				Operation *operation = branch->value;
+
+				if (operation->element_a == NULL || operation->element_b == NULL) {
+					whoops("misplaced operator (maybe you need to put some brackets around one of your expressions?)");
+				}
+
+				switch (operation->type) {
+					case OPERATION_JUXTAPOSITION:
+						{
+							// evaluate each operand to obtain the actual values we need to operate on
+							Element *element_a = evaluate(operation->element_a, keep_stack, scopes_stack, heap);
+							*keep_stack = Stack_push(*keep_stack, element_a);
+							Element *element_b = evaluate(operation->element_b, keep_stack, scopes_stack, heap);
+							*keep_stack = Stack_pop(*keep_stack);
+
+							// in tail position, leave the application to the call that this expression ends
+							if (tail_function != NULL) {
+								*tail_function = element_a;
+								*tail_argument = element_b;
+								return NULL;
+							}
+
+							return juxtapose(element_a, element_b, keep_stack, scopes_stack, heap);
+						};
+						break;
+
+					case OPERATION_CLOSURE:
+						{
+							// if a variable name is not specified, don't bother setting it
+							// otherwise, use the variable name specified
+							Element *variable = operation->element_a->type == ELEMENT_NULL ? NULL : operation->element_a;
+
+							// the Closure keeps the innermost Scope so that it can use every Scope available where it was made
+							return make(ELEMENT_CLOSURE, Closure_new(operation->element_b, variable, scopes, NULL), heap);
+						};
+						break;
+
+					case OPERATION_ACCESS:
+						{
+							Element *subject = evaluate(operation->element_a, keep_stack, scopes_stack, heap);
+							return access_property(subject, operation->element_b);
+						};
+						break;
+
+					case OPERATION_AND:
+					case OPERATION_OR:
+						{
+							// evaluate the first operand
+							Element *element_a = evaluate(operation->element_a, keep_stack, scopes_stack, heap);
+							*keep_stack = Stack_push(*keep_stack, element_a);
+
+							// return either the first or second operand evaluations based on whether or not the operation is && or || and whether or not the first operand evaluation is truthy
+							Element *result =
+								operation->type == OPERATION_AND != value_is_truthy(element_a) ? element_a :
+								evaluate(operation->element_b, keep_stack, scopes_stack, heap);
+
+							*keep_stack = Stack_pop(*keep_stack);
+
+							return result;
+						};
+						break;
+
+					default:
+						{
+							// evaluate each operand to obtain the actual values we need to operate on
+							Element *element_a = evaluate(operation->element_a, keep_stack, scopes_stack, heap);
+							*keep_stack = Stack_push(*keep_stack, element_a);
+							Element *element_b = evaluate(operation->element_b, keep_stack, scopes_stack, heap);
+							*keep_stack = Stack_pop(*keep_stack);
+
+							return perform_operation(operation->type, element_a, element_b, heap);
+						};
+				}
+			};
+			break;
+
+		default:
+			return branch;
+	}
+}
+
+// function to make and initialise a new Program
+Program *Program_new() {
+	Program *new_program = malloc(sizeof(Program));
+	new_program->code = NULL;
+	new_program->length = 0;
+	new_program->capacity = 0;
+	new_program->constants = Stack_new();
+	new_program->prototypes = Stack_new();
+	new_program->addresses = Stack_new();
+	new_program->caches = Stack_new();
+	new_program->loops = Stack_new();
+	new_program->static_scopes = Stack_new();
+	new_program->scope = NULL;
+	return new_program;
+}
+
+// function to free a Program and everything it owns
+// the constants themselves are owned by the abstract syntax tree, so they are left alone
+void Program_free(Program *program) {
+	for (size_t i = 0; i < program->prototypes->length; i++) {
+		free(program->prototypes->content[i]);
+	}
+
+	for (size_t i = 0; i < program->addresses->length; i++) {
+		free(program->addresses->content[i]);
+	}
+
+	for (size_t i = 0; i < program->caches->length; i++) {
+		free(program->caches->content[i]);
+	}
+
+	for (size_t i = 0; i < program->loops->length; i++) {
+		Loop *loop = program->loops->content[i];
+
+#ifdef JIT_SUPPORTED
+		if (loop->native != NULL) {
+			munmap(loop->native, loop->native_size);
+		}
+#endif
+
+		free(loop);
+	}
+
+	for (size_t i = 0; i < program->static_scopes->length; i++) {
+		StaticScope *scope = program->static_scopes->content[i];
+		free(scope->names);
+		free(scope);
+	}
+
+	free(program->prototypes);
+	free(program->addresses);
+	free(program->caches);
+	free(program->loops);
+	free(program->static_scopes);
+	free(program->constants);
+	free(program->code);
+	free(program);
+}
+
+// function to add an instruction to the end of a Program and return its position so that it can be patched later if necessary
+size_t emit(Program *program, Opcode opcode, size_t operand) {
+	// grow the instruction list geometrically so that compiling large scripts doesn't require a reallocation for every instruction
+	if (program->length == program->capacity) {
+		program->capacity = program->capacity == 0 ? 64 : program->capacity * 2;
+		program->code = realloc(program->code, program->capacity * sizeof(Instruction));
+	}
+
+	program->code[program->length].opcode = opcode;
+	program->code[program->length].operand = operand;
+
+	return program->length++;
+}
+
+// function to add a constant to a Program and return its index so that instructions can refer to it
+size_t add_constant(Program *program, void *constant) {
+	program->constants = Stack_push(program->constants, constant);
+	return program->constants->length - 1;
+}
+
+// function to add an empty InlineCache for a certain property name to a Program and return its index so that an instruction can refer to it
+size_t add_inline_cache(Program *program, Element *name) {
+	InlineCache *cache = malloc(sizeof(InlineCache));
+	cache->name = name;
+	cache->length = 0;
+	cache->next = 0;
+
+	program->caches = Stack_push(program->caches, cache);
+	return program->caches->length - 1;
+}
+
+// function to add an Address to a Program and return its index so that a lexical instruction can refer to it
+size_t add_address(Program *program, Element *name, size_t depth, size_t slot) {
+	Address *address = malloc(sizeof(Address));
+	address->name = name;
+	address->depth = depth;
+	address->slot = slot;
+
+	program->addresses = Stack_push(program->addresses, address);
+	return program->addresses->length - 1;
+}
+
+// function to add a Prototype for a Closure expression found in the code that is currently being compiled to a Program and return its index so that a closure instruction can refer to it
+size_t add_prototype(Program *program, Element *expression, Element *variable, size_t entry) {
+	Prototype *prototype = malloc(sizeof(Prototype));
+	prototype->expression = expression;
+	prototype->variable = variable;
+	prototype->scope = program->scope;
+	prototype->entry = entry;
+
+	program->prototypes = Stack_push(program->prototypes, prototype);
+	return program->prototypes->length - 1;
+}
+
+// function to add a Loop that jumps back to a certain position to a Program and return its index so that the loop instruction can refer to it
+// the loop instruction has to be emitted straight afterwards
+size_t add_loop(Program *program, size_t start) {
+	Loop *loop = malloc(sizeof(Loop));
+	loop->start = start;
+	loop->end = program->length;
+	loop->iterations = 0;
+	loop->native = NULL;
+	loop->native_size = 0;
+
+	program->loops = Stack_push(program->loops, loop);
+	return program->loops->length - 1;
+}
+
+// function to push a value onto the value stack of a VM
+void push_value(VM *vm, Element *value) {
+	vm->values = Stack_push(vm->values, value);
+}
+
+// function to pop a value off the top of the value stack of a VM
+Element *pop_value(VM *vm) {
+	Element *value = vm->values->content[vm->values->length - 1];
+	vm->values = Stack_pop(vm->values);
+	return value;
+}
+
+// function to look at a value on the value stack of a VM without removing it, where a depth of 0 is the top of the stack
+Element *peek_value(VM *vm, size_t depth) {
+	return vm->values->content[vm->values->length - 1 - depth];
+}
+
+// function to start a call to a compiled Closure by switching to the innermost Scope in which its expression is evaluated
+void enter_closure(VM *vm, Element *function, Element *argument, Instruction *return_address) {
+	vm->scopes_stack = Stack_push(vm->scopes_stack, prepare_closure_scopes(function->value, argument, vm->heap));
+	vm->returns = Stack_push(vm->returns, return_address);
+}
+
+// function to start a call to a compiled Closure in place of the call that is in progress, so that it returns to wherever the current call would have returned to
+void replace_closure(VM *vm, Element *function, Element *argument) {
+	vm->scopes_stack->content[vm->scopes_stack->length - 1] = prepare_closure_scopes(function->value, argument, vm->heap);
+}
+
+// function to apply a value to another value from within an instruction, running a compiled Closure to completion before returning
+Element *apply(VM *vm, Element *function, Element *argument) {
+	if (function->type == ELEMENT_CLOSURE && ((Closure*)function->value)->code != NULL) {
+		enter_closure(vm, function, argument, NULL);
+		return vm->run(vm, ((Closure*)function->value)->code);
+	}
+
+	return juxtapose(function, argument, &vm->values, &vm->scopes_stack, vm->heap);
+}
+
+// function to apply a Closure to each key or value of a Scope, in order of its addition to the Scope
+// the Scope and the Closure stay on the value stack until the iteration is complete so they are not garbage collected prematurely
+void iterate_scope(VM *vm, bool keys) {
+	Element *closure = peek_value(vm, 0);
+	Element *subject = peek_value(vm, 1);
+
+	// the Scope is retrieved anew for every mapping in case the Closure changes it
+	for (size_t i = 0; i < ((Scope*)subject->value)->used; i++) {
+		Map *map = &((Scope*)subject->value)->maps[i];
+
+		// skip over the gaps left by deleted mappings
+		if (map->key == NULL) {
+			continue;
+		}
+
+		Element *item = keys ? map->key : map->value;
+
+		// property names are not applied to the Closure
+		if (item->type != ELEMENT_VARIABLE) {
+			apply(vm, closure, item);
+		}
+	}
+
+	pop_value(vm);
+	pop_value(vm);
+}
+
+// function to find the position of a property in a Scope's list of mappings, using an InlineCache to skip the search if a Scope of the same Shape has been seen before
+// if there is no such property, the length of the list is returned instead
+size_t find_cached_property(Scope *scope, InlineCache *cache) {
+	Shape *shape = scope->shape;
+
+	// Scopes without a Shape have to be searched every time
+	if (shape == NULL) {
+		return find_scope_mapping(scope, cache->name);
+	}
+
+	for (size_t i = 0; i < cache->length; i++) {
+		if (cache->shapes[i] == shape) {
+			return cache->slots[i];
+		}
+	}
+
+	size_t position = find_scope_mapping(scope, cache->name);
+
+	// remember where the property was found for Scopes of this Shape, replacing the oldest entry once the cache is full
+	if (position < scope->used) {
+		size_t entry;
+		if (cache->length < INLINE_CACHE_SIZE) {
+			entry = cache->length;
+			cache->length++;
+		} else {
+			entry = cache->next;
+			cache->next = (cache->next + 1) % INLINE_CACHE_SIZE;
+		}
+
+		cache->shapes[entry] = shape;
+		cache->slots[entry] = position;
+	}
+
+	return position;
+}
+
+// function to retrieve the value of a property of a Scope Element using an InlineCache
+Element *access_cached_property(Element *subject, InlineCache *cache) {
+	if (subject->type == ELEMENT_SCOPE) {
+		Scope *scope = subject->value;
+
+		size_t position = find_cached_property(scope, cache);
+		if (position < scope->used) {
+			return scope->maps[position].value;
+		}
+	}
+
+	// let the uncached version report the error
+	return access_property(subject, cache->name);
+}
+
+// function to change the value of a property of a Scope Element using an InlineCache, adding the property if it doesn't exist yet
+void edit_cached_property(Element *subject, InlineCache *cache, Element *value, Heap *heap) {
+	Scope *scope = subject->value;
+
+	size_t position = find_cached_property(scope, cache);
+	if (position < scope->used) {
+		scope->maps[position].value = value;
+		write_barrier(subject, heap);
+	} else {
+		set_scope_mapping_dynamically(subject, cache->name, value, heap);
+	}
+}
+
+// function to find the Scope that holds a variable at a certain Address, starting from the innermost Scope
+// NULL is returned if the variable isn't where it was expected to be, in which case it has to be searched for by name instead
+Element *find_lexical_scope(Element *scopes, Address *address) {
+	Element *scope = scopes;
+
+	for (size_t i = 0; i < address->depth; i++) {
+		// a Scope that has gained a key dynamically might now have the variable, so it can't be skipped over
+		if (scope == NULL || ((Scope*)scope->value)->changed_dynamically) {
+			return NULL;
+		}
+
+		scope = ((Scope*)scope->value)->parent;
+	}
+
+	if (scope == NULL) {
+		return NULL;
+	}
+
+	// the variable is only where it was expected to be if the mapping at its slot was added using the same key that defined it
+	Scope *scope_value = scope->value;
+	if (address->slot >= scope_value->used || scope_value->maps[address->slot].key != address->name) {
+		return NULL;
+	}
+
+	return scope;
+}
+
+// function to get the value of the variable at a certain Address, searching for it by name if it isn't where it was expected to be
+Element *get_lexical_variable(Element *scopes, Address *address) {
+	Element *scope = find_lexical_scope(scopes, address);
+
+	if (scope != NULL) {
+		return ((Scope*)scope->value)->maps[address->slot].value;
+	}
+
+	return get_variable(address->name, scopes);
+}
+
+// function to set the value of the variable at a certain Address, searching for it by name if it isn't where it was expected to be
+void set_lexical_variable(Element *scopes, Address *address, Element *value, bool local_only, Heap *heap) {
+	Element *scope = find_lexical_scope(scopes, address);
+
+	if (scope != NULL) {
+		((Scope*)scope->value)->maps[address->slot].value = value;
+		write_barrier(scope, heap);
+	} else {
+		set_variable(address->name, value, scopes, local_only, heap);
+	}
+}
+
+// function to check whether an Element is an integer Number
+bool is_integer(Element *element) {
+	return element->type == ELEMENT_NUMBER && !((Number*)element->value)->is_double;
+}
+
+// function to check whether an Element is a floating-point Number
+bool is_double(Element *element) {
+	return element->type == ELEMENT_NUMBER && ((Number*)element->value)->is_double;
+}
+
+// function to perform an operation at a generic operator site and rewrite the site into a quickened instruction if its operands suit one
+// the site is only quickened for numeric operations, and a site that has no quickened instruction for a type is given its own opcode for that type
+Element *operate_and_quicken(Instruction *site, Opcode integer_opcode, Opcode double_opcode, OperationType operation_type, Element *element_a, Element *element_b, Heap *heap) {
+	switch (operation_type) {
+		case OPERATION_ADDITION:
+		case OPERATION_SUBTRACTION:
+		case OPERATION_MULTIPLICATION:
+		case OPERATION_DIVISION:
+		case OPERATION_REMAINDER:
+		case OPERATION_POW:
+		case OPERATION_LT:
+		case OPERATION_GT:
+		case OPERATION_LTE:
+		case OPERATION_GTE:
+			if (is_integer(element_a) && is_integer(element_b)) {
+				site->opcode = integer_opcode;
+			} else if (is_double(element_a) && is_double(element_b)) {
+				site->opcode = double_opcode;
+			}
+			break;
+	}
+
+	return perform_operation(operation_type, element_a, element_b, heap);
+}
+
+// function to perform an operation at an operator site that has been quickened for integers
+// if either operand isn't an integer, the site is deoptimised back into its generic opcode and the operation is performed the generic way
+Element *operate_on_integer_elements(Instruction *site, Opcode generic_opcode, OperationType operation_type, Element *element_a, Element *element_b, Heap *heap) {
+	Number *number_a = element_a->value;
+	Number *number_b = element_b->value;
+
+	if (element_a->type != ELEMENT_NUMBER || element_b->type != ELEMENT_NUMBER || number_a->is_double || number_b->is_double) {
+		site->opcode = generic_opcode;
+	} else {
+		Number result;
+
+		if (operate_on_integers(operation_type, number_a->value_long, number_b->value_long, &result)) {
+			return make_number(result, heap);
+		}
+	}
+
+	return perform_operation(operation_type, element_a, element_b, heap);
+}
+
+// function to perform an operation at an operator site that has been quickened for floating-point values
+// if either operand isn't a floating-point value, the site is deoptimised back into its generic opcode and the operation is performed the generic way
+Element *operate_on_double_elements(Instruction *site, Opcode generic_opcode, OperationType operation_type, Element *element_a, Element *element_b, Heap *heap) {
+	Number *number_a = element_a->value;
+	Number *number_b = element_b->value;
+
+	if (element_a->type != ELEMENT_NUMBER || element_b->type != ELEMENT_NUMBER || !number_a->is_double || !number_b->is_double) {
+		site->opcode = generic_opcode;
+	} else {
+		Number result;
+
+		if (operate_on_doubles(operation_type, number_a->value_double, number_b->value_double, &result)) {
+			return make_number(result, heap);
+		}
+	}
+
+	return perform_operation(operation_type, element_a, element_b, heap);
+}
+
+// function to perform the operation of an operator site in whichever form the site is currently in
+Element *operate_at_site(Instruction *site, Element *element_a, Element *element_b, Heap *heap) {
+	switch (site->opcode) {
+		case OPCODE_OPERATE_INTEGER:
+			return operate_on_integer_elements(site, OPCODE_OPERATE, site->operand, element_a, element_b, heap);
+		case OPCODE_OPERATE_DOUBLE:
+			return operate_on_double_elements(site, OPCODE_OPERATE, site->operand, element_a, element_b, heap);
+		default:
+			return operate_and_quicken(site, OPCODE_OPERATE_INTEGER, OPCODE_OPERATE_DOUBLE, site->operand, element_a, element_b, heap);
+	}
+}
+
+// function to get the innermost Scope of the Closure call that a VM is currently in
+Element *innermost_scope(VM *vm) {
+	return vm->scopes_stack->content[vm->scopes_stack->length - 1];
+}
+
+// function to do the work of an UPDATE_LEXICAL instruction, which updates a variable using its own value and a constant
+// the constant, the operation and the Address to store the result at are taken from the instructions that were replaced
+void update_lexical_variable(VM *vm, Instruction *instruction) {
+	Element *scopes = innermost_scope(vm);
+	Element *constant = vm->program->constants->content[instruction[1].operand];
+	OperationType operation_type = instruction[2].operand;
+	Address *destination = vm->program->addresses->content[instruction[3].operand];
+	bool local_only = instruction[3].opcode == OPCODE_LET_LEXICAL;
+
+	Element *value = get_lexical_variable(scopes, vm->program->addresses->content[instruction->operand]);
+
+	// the result is only worked out the quickened way if this instruction has been quickened
+	if (instruction->opcode == OPCODE_UPDATE_LEXICAL_INTEGER) {
+		value = operate_on_integer_elements(instruction, OPCODE_UPDATE_LEXICAL, operation_type, value, constant, vm->heap);
+	} else {
+		value = operate_and_quicken(instruction, OPCODE_UPDATE_LEXICAL_INTEGER, OPCODE_UPDATE_LEXICAL, operation_type, value, constant, vm->heap);
+	}
+
+	set_lexical_variable(scopes, destination, value, local_only, vm->heap);
+}
+
+// function to do the work of an OPERATE_JUMP_IF_FALSE instruction up to the jump, returning whether the result of the operation is truthy
+bool operate_and_test(VM *vm, Instruction *instruction) {
+	Element *element_b = pop_value(vm);
+	Element *element_a = pop_value(vm);
+
+	Element *result;
+
+	if (instruction->opcode == OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE) {
+		result = operate_on_integer_elements(instruction, OPCODE_OPERATE_JUMP_IF_FALSE, instruction->operand, element_a, element_b, vm->heap);
+	} else {
+		result = operate_and_quicken(instruction, OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE, OPCODE_OPERATE_JUMP_IF_FALSE, instruction->operand, element_a, element_b, vm->heap);
+	}
+
+	return value_is_truthy(result);
+}
+
+// functions that machine code and scripts compiled to C call to do the work of each instruction
+// each one does the same work as the instruction does in run(), but finds the innermost Scope through the VM, since compiled code doesn't keep track of it
+
+void do_get_variable(VM *vm, Instruction *instruction) {
+	push_value(vm, get_variable(vm->program->constants->content[instruction->operand], innermost_scope(vm)));
+}
+
+void do_get_lexical(VM *vm, Instruction *instruction) {
+	push_value(vm, get_lexical_variable(innermost_scope(vm), vm->program->addresses->content[instruction->operand]));
+}
+
+void do_enter_sequence(VM *vm, Instruction *instruction) {
+	vm->scopes_stack->content[vm->scopes_stack->length - 1] = make(ELEMENT_SCOPE, Scope_new(innermost_scope(vm)), vm->heap);
+}
+
+void do_leave_sequence(VM *vm, Instruction *instruction) {
+	Element *scopes = innermost_scope(vm);
+	push_value(vm, scopes);
+	vm->scopes_stack->content[vm->scopes_stack->length - 1] = ((Scope*)scopes->value)->parent;
+}
+
+void do_exit_sequence(VM *vm, Instruction *instruction) {
+	vm->scopes_stack->content[vm->scopes_stack->length - 1] = ((Scope*)innermost_scope(vm)->value)->parent;
+}
+
+void do_operate(VM *vm, Instruction *instruction) {
+	Element *element_b = pop_value(vm);
+	Element *element_a = pop_value(vm);
+	push_value(vm, operate_at_site(instruction, element_a, element_b, vm->heap));
+}
+
+void do_access(VM *vm, Instruction *instruction) {
+	push_value(vm, access_cached_property(pop_value(vm), vm->program->caches->content[instruction->operand]));
+}
+
+void do_closure(VM *vm, Instruction *instruction) {
+	Prototype *prototype = vm->program->prototypes->content[instruction->operand];
+	push_value(vm, make(ELEMENT_CLOSURE, Closure_new(prototype->expression, prototype->variable, innermost_scope(vm), vm->program->code + prototype->entry), vm->heap));
+}
+
+void do_print(VM *vm, Instruction *instruction) {
+	print_value(pop_value(vm), 0, instruction->operand);
+}
+
+void do_set_variable(VM *vm, Instruction *instruction) {
+	set_variable(vm->program->constants->content[instruction->operand], pop_value(vm), innermost_scope(vm), instruction->opcode == OPCODE_LET, vm->heap);
+}
+
+void do_set_lexical(VM *vm, Instruction *instruction) {
+	set_lexical_variable(innermost_scope(vm), vm->program->addresses->content[instruction->operand], pop_value(vm), instruction->opcode == OPCODE_LET_LEXICAL, vm->heap);
+}
+
+void do_mut(VM *vm, Instruction *instruction) {
+	Element *value = pop_value(vm);
+	Element *key = pop_value(vm);
+	Element *subject = pop_value(vm);
+	set_scope_mapping_dynamically(subject, key, value, vm->heap);
+}
+
+void do_edit(VM *vm, Instruction *instruction) {
+	Element *value = pop_value(vm);
+	Element *subject = pop_value(vm);
+	edit_cached_property(subject, vm->program->caches->content[instruction->operand], value, vm->heap);
+}
+
+void do_expect(VM *vm, Instruction *instruction) {
+	ElementType type = instruction->opcode == OPCODE_EXPECT_SCOPE ? ELEMENT_SCOPE : instruction->opcode == OPCODE_EXPECT_STRING ? ELEMENT_STRING : ELEMENT_CLOSURE;
+
+	if (peek_value(vm, 0)->type != type) {
+		whoops(vm->program->constants->content[instruction->operand]);
+	}
+}
+
+void do_collect(VM *vm, Instruction *instruction) {
+	garbage_collect_if_due(NULL, &vm->values, &vm->scopes_stack, vm->heap);
+}
+
+void do_rand(VM *vm, Instruction *instruction) {
+	set_variable(vm->program->constants->content[instruction->operand], make_random_number(vm->heap), innermost_scope(vm), true, vm->heap);
+}
+
+void do_length(VM *vm, Instruction *instruction) {
+	set_variable(vm->program->constants->content[instruction->operand], measure_string(pop_value(vm), vm->heap), innermost_scope(vm), true, vm->heap);
+}
+
+void do_input(VM *vm, Instruction *instruction) {
+	set_variable(vm->program->constants->content[instruction->operand], read_input(vm->heap), innermost_scope(vm), true, vm->heap);
+}
+
+void do_readfile(VM *vm, Instruction *instruction) {
+	set_variable(vm->program->constants->content[instruction->operand], read_file_element(pop_value(vm), vm->heap), innermost_scope(vm), true, vm->heap);
+}
+
+void do_writefile(VM *vm, Instruction *instruction) {
+	Element *path = pop_value(vm);
+	Element *new_contents = pop_value(vm);
+	set_variable(vm->program->constants->content[instruction->operand], write_file_element(new_contents, path, vm->heap), innermost_scope(vm), true, vm->heap);
+}
+
+void do_unmap(VM *vm, Instruction *instruction) {
+	Element *key = pop_value(vm);
+	Element *subject = pop_value(vm);
+	subject->value = delete_scope_mapping(subject->value, key);
+}
+
+void do_delete(VM *vm, Instruction *instruction) {
+	Element *subject = pop_value(vm);
+	subject->value = delete_scope_mapping(subject->value, vm->program->constants->content[instruction->operand]);
+}
+
+void do_iterate(VM *vm, Instruction *instruction) {
+	iterate_scope(vm, instruction->opcode == OPCODE_KEYS);
+}
+
+void do_fail(VM *vm, Instruction *instruction) {
+	whoops(vm->program->constants->content[instruction->operand]);
+}
+
+// the following functions return whether compiled code should jump to the target of the instruction
+
+bool do_jump_if_false(VM *vm, Instruction *instruction) {
+	return !value_is_truthy(pop_value(vm));
+}
+
+bool do_short_circuit(VM *vm, Instruction *instruction) {
+	if ((instruction->opcode == OPCODE_AND) != value_is_truthy(peek_value(vm, 0))) {
+		return true;
+	}
+
+	pop_value(vm);
+	return false;
+}
+
+bool do_operate_jump_if_false(VM *vm, Instruction *instruction) {
+	return !operate_and_test(vm, instruction);
+}
+
+// the following functions return false without doing anything if the instruction is a call to a compiled Closure, which machine code leaves to run() and scripts compiled to C make with do_call() or do_call_lexical()
+
+bool do_apply(VM *vm, Instruction *instruction) {
+	Element *element_a = peek_value(vm, 1);
+
+	if (element_a->type == ELEMENT_CLOSURE && ((Closure*)element_a->value)->code != NULL) {
+		return false;
+	}
+
+	Element *element_b = pop_value(vm);
+	pop_value(vm);
+	push_value(vm, juxtapose(element_a, element_b, &vm->values, &vm->scopes_stack, vm->heap));
+	return true;
+}
+
+bool do_apply_lexical(VM *vm, Instruction *instruction) {
+	Element *element_a = peek_value(vm, 0);
+
+	if (element_a->type == ELEMENT_CLOSURE && ((Closure*)element_a->value)->code != NULL) {
+		return false;
+	}
+
+	Element *element_b = get_lexical_variable(innermost_scope(vm), vm->program->addresses->content[instruction->operand]);
+	pop_value(vm);
+	push_value(vm, juxtapose(element_a, element_b, &vm->values, &vm->scopes_stack, vm->heap));
+	return true;
+}
+
+// the following functions start a call to a compiled Closure that do_apply() or do_apply_lexical() refused to make, returning the instruction to continue from
+// the call returns to the instruction after the application
+
+Instruction *do_call(VM *vm, Instruction *instruction) {
+	Element *element_b = pop_value(vm);
+	Element *element_a = pop_value(vm);
+	enter_closure(vm, element_a, element_b, instruction + 1);
+	return ((Closure*)element_a->value)->code;
+}
+
+Instruction *do_call_lexical(VM *vm, Instruction *instruction) {
+	Element *element_b = get_lexical_variable(innermost_scope(vm), vm->program->addresses->content[instruction->operand]);
+	Element *element_a = pop_value(vm);
+	enter_closure(vm, element_a, element_b, instruction + 2);
+	return ((Closure*)element_a->value)->code;
+}
+
+// function to start a call to a compiled Closure in tail position that do_apply() refused to make, returning the instruction to continue from
+Instruction *do_tail_call(VM *vm, Instruction *instruction) {
+	Element *element_b = pop_value(vm);
+	Element *element_a = pop_value(vm);
+	replace_closure(vm, element_a, element_b);
+	return ((Closure*)element_a->value)->code;
+}
+
+// function to end a call to a compiled Closure, returning the instruction to return to, or NULL if the result should be handed back to the caller of the compiled code
+Instruction *do_return(VM *vm, Instruction *instruction) {
+	vm->scopes_stack = Stack_pop(vm->scopes_stack);
+
+	Instruction *return_address = vm->returns->content[vm->returns->length - 1];
+	vm->returns = Stack_pop(vm->returns);
+
+	return return_address;
+}
+
+#ifdef JIT_SUPPORTED
+// function to make a new Number Element for an integer that the machine code of a loop has worked out and push it onto the value stack
+void jit_push_integer(VM *vm, long value) {
+	Number number = {0};
+	number.value_long = value;
+	push_value(vm, make_number(number, vm->heap));
+}
+
+// function to make a new Number Element for a floating-point value that the machine code of a loop has worked out and push it onto the value stack
+void jit_push_double(VM *vm, double value) {
+	Number number = {0};
+	number.is_double = true;
+	number.value_double = value;
+	push_value(vm, make_number(number, vm->heap));
+}
+
+// enumeration type used to represent the conditions that x86-64 conditional jumps can check, numbered as they are in the jump instructions themselves
+// each condition is one away from its opposite, so flipping the lowest bit of a condition gives the opposite condition
+typedef enum {
+	CONDITION_BELOW = 0x2,
+	CONDITION_ABOVE_OR_EQUAL = 0x3,
+	CONDITION_EQUAL = 0x4,
+	CONDITION_NOT_EQUAL = 0x5,
+	CONDITION_BELOW_OR_EQUAL = 0x6,
+	CONDITION_ABOVE = 0x7,
+} Condition;
+
+// type used to remember a jump in the machine code of a loop whose distance has to be filled in once the position of its target is known
+typedef struct {
+	// the position of the distance in the machine code
+	size_t position;
+
+	// the instruction to jump to, or SIZE_MAX to jump to the end of the machine code
+	size_t target;
+} Fixup;
+
+// type used to build the machine code of a loop
+typedef struct {
+	unsigned char *content;
+	size_t length;
+	size_t capacity;
+
+	// the part of the Program that is being compiled
+	Instruction *code;
+	size_t start;
+	size_t end;
+
+	Fixup *fixups;
+	size_t fixups_length;
+} Assembler;
+
+// function to add some bytes to the end of the machine code
+void assemble_bytes(Assembler *assembler, void *bytes, size_t length) {
+	if (assembler->length + length > assembler->capacity) {
+		assembler->capacity = (assembler->length + length) * 2;
+		assembler->content = realloc(assembler->content, assembler->capacity);
+	}
+
+	memcpy(assembler->content + assembler->length, bytes, length);
+	assembler->length += length;
+}
+
+// function to add a 32-bit value to the end of the machine code
+void assemble_u32(Assembler *assembler, uint32_t value) {
+	assemble_bytes(assembler, &value, sizeof(value));
+}
+
+// function to add a 64-bit value to the end of the machine code
+void assemble_u64(Assembler *assembler, uint64_t value) {
+	assemble_bytes(assembler, &value, sizeof(value));
+}
+
+// function to add a placeholder for the distance of a jump to the end of the machine code, which will later point at a certain instruction
+void assemble_distance(Assembler *assembler, size_t target) {
+	assembler->fixups[assembler->fixups_length].position = assembler->length;
+	assembler->fixups[assembler->fixups_length].target = target;
+	assembler->fixups_length++;
+
+	assemble_u32(assembler, 0);
+}
+
+// function to jump further ahead within the machine code for the current instruction if a condition holds
+// the position of the distance is returned so that the jump can be pointed at its destination with land_jump() once the destination has been reached
+size_t assemble_jump_ahead(Assembler *assembler, Condition condition) {
+	// jcc with a 32-bit distance
+	unsigned char opcode[] = {0x0F, 0x80 | condition};
+	assemble_bytes(assembler, opcode, 2);
+
+	size_t position = assembler->length;
+	assemble_u32(assembler, 0);
+	return position;
+}
+
+// function to jump further ahead within the machine code for the current instruction, returning the position of the distance just like assemble_jump_ahead()
+size_t assemble_skip_ahead(Assembler *assembler) {
+	// jmp with a 32-bit distance
+	assemble_bytes(assembler, "\xE9", 1);
+
+	size_t position = assembler->length;
+	assemble_u32(assembler, 0);
+	return position;
+}
+
+// function to point a jump made with assemble_jump_ahead() or assemble_skip_ahead() at the current end of the machine code
+void land_jump(Assembler *assembler, size_t position) {
+	int32_t distance = assembler->length - (position + 4);
+	memcpy(assembler->content + position, &distance, 4);
+}
+
+// function to call a function with the VM as its first argument, leaving whatever is already in the other argument registers alone
+void assemble_call_with_vm(Assembler *assembler, void *function) {
+	// mov rdi, rbx
+	assemble_bytes(assembler, "\x48\x89\xDF", 3);
+
+	// mov rax, function
+	assemble_bytes(assembler, "\x48\xB8", 2);
+	assemble_u64(assembler, (uintptr_t)function);
+
+	// call rax
+	assemble_bytes(assembler, "\xFF\xD0", 2);
+}
+
+// function to call a function with the VM and a pointer as its arguments
+void assemble_call(Assembler *assembler, void *function, void *argument) {
+	// mov rsi, argument
+	assemble_bytes(assembler, "\x48\xBE", 2);
+	assemble_u64(assembler, (uintptr_t)argument);
+
+	assemble_call_with_vm(assembler, function);
+}
+
+// function to leave the machine code and continue running a certain instruction in run()
+// this always takes up 15 bytes, so that conditional jumps can skip over it
+void assemble_exit(Assembler *assembler, Instruction *instruction) {
+	// mov rax, instruction
+	assemble_bytes(assembler, "\x48\xB8", 2);
+	assemble_u64(assembler, (uintptr_t)instruction);
+
+	// jmp to the end of the machine code
+	assemble_bytes(assembler, "\xE9", 1);
+	assemble_distance(assembler, SIZE_MAX);
+}
+
+// function to jump to a certain instruction, leaving the machine code if the instruction isn't part of the loop
+void assemble_jump(Assembler *assembler, size_t target) {
+	if (target < assembler->start || target > assembler->end) {
+		assemble_exit(assembler, assembler->code + target);
+		return;
+	}
+
+	// jmp to the instruction
+	assemble_bytes(assembler, "\xE9", 1);
+	assemble_distance(assembler, target);
+}
+
+// function to jump to a certain instruction if a condition holds, leaving the machine code if the instruction isn't part of the loop
+void assemble_jump_if(Assembler *assembler, Condition condition, size_t target) {
+	if (target < assembler->start || target > assembler->end) {
+		// jcc past the exit using the opposite condition
+		unsigned char skip[] = {0x70 | (condition ^ 1), 0x0F};
+		assemble_bytes(assembler, skip, 2);
+		assemble_exit(assembler, assembler->code + target);
+		return;
+	}
+
+	// jcc to the instruction
+	unsigned char opcode[] = {0x0F, 0x80 | condition};
+	assemble_bytes(assembler, opcode, 2);
+	assemble_distance(assembler, target);
+}
+
+// function to jump to a certain instruction if the last function that was called returned true
+void assemble_jump_if_true(Assembler *assembler, size_t target) {
+	// test al, al
+	assemble_bytes(assembler, "\x84\xC0", 2);
+	assemble_jump_if(assembler, CONDITION_NOT_EQUAL, target);
+}
+
+// function to leave the machine code and run a certain instruction in run() if the last function that was called returned false
+void assemble_exit_if_false(Assembler *assembler, size_t position) {
+	// test al, al
+	assemble_bytes(assembler, "\x84\xC0", 2);
+
+	// jnz past the exit
+	assemble_bytes(assembler, "\x75\x0F", 2);
+	assemble_exit(assembler, assembler->code + position);
+}
+
+// function to load the value stack into rax and its length into rcx
+void assemble_load_values(Assembler *assembler) {
+	// mov rax, [rbx + values]
+	assemble_bytes(assembler, "\x48\x8B\x83", 3);
+	assemble_u32(assembler, offsetof(VM, values));
+
+	// mov rcx, [rax + length]
+	assemble_bytes(assembler, "\x48\x8B\x88", 3);
+	assemble_u32(assembler, offsetof(Stack, length));
+}
+
+// function to push a constant Element onto the value stack, only calling push_value() when the value stack needs to grow
+void assemble_push_constant(Assembler *assembler, Element *constant) {
+	assemble_load_values(assembler);
+
+	// cmp rcx, [rax + capacity]
+	assemble_bytes(assembler, "\x48\x3B\x88", 3);
+	assemble_u32(assembler, offsetof(Stack, capacity));
+	size_t full = assemble_jump_ahead(assembler, CONDITION_ABOVE_OR_EQUAL);
+
+	// mov rdx, constant
+	assemble_bytes(assembler, "\x48\xBA", 2);
+	assemble_u64(assembler, (uintptr_t)constant);
+
+	// mov [rax + rcx * 8 + content], rdx
+	assemble_bytes(assembler, "\x48\x89\x94\xC8", 4);
+	assemble_u32(assembler, offsetof(Stack, content));
+
+	// inc rcx; mov [rax + length], rcx
+	assemble_bytes(assembler, "\x48\xFF\xC1\x48\x89\x88", 6);
+	assemble_u32(assembler, offsetof(Stack, length));
+
+	size_t done = assemble_skip_ahead(assembler);
+
+	// the value stack may need to be reallocated, so leave that to push_value()
+	land_jump(assembler, full);
+	assemble_call(assembler, push_value, constant);
+	land_jump(assembler, done);
+}
+
+// function to pop the top value off the value stack
+// the value stack is never shrunk here, which leaves it with room to grow again on the next iteration of the loop
+void assemble_pop(Assembler *assembler) {
+	// mov rax, [rbx + values]
+	assemble_bytes(assembler, "\x48\x8B\x83", 3);
+	assemble_u32(assembler, offsetof(VM, values));
+
+	// dec qword [rax + length]
+	assemble_bytes(assembler, "\x48\xFF\x88", 3);
+	assemble_u32(assembler, offsetof(Stack, length));
+}
+
+// function to load the Numbers of the two values at the top of the value stack into rsi and rdx, with the top value's Number in rdx
+// if either value isn't a Number whose kind matches is_double, the machine code jumps ahead to a slow path instead, and the positions of those jumps are written to guards so that they can be landed there
+void assemble_load_numbers(Assembler *assembler, bool is_double, size_t guards[4]) {
+	assemble_load_values(assembler);
+
+	// mov rdx, [rax + rcx * 8 + content - 8]; mov rsi, [rax + rcx * 8 + content - 16]
+	assemble_bytes(assembler, "\x48\x8B\x94\xC8", 4);
+	assemble_u32(assembler, offsetof(Stack, content) - sizeof(void*));
+	assemble_bytes(assembler, "\x48\x8B\xB4\xC8", 4);
+	assemble_u32(assembler, offsetof(Stack, content) - 2 * sizeof(void*));
+
+	// cmp dword [rsi + type], ELEMENT_NUMBER; jne slow
+	assemble_bytes(assembler, "\x81\xBE", 2);
+	assemble_u32(assembler, offsetof(Element, type));
+	assemble_u32(assembler, ELEMENT_NUMBER);
+	guards[0] = assemble_jump_ahead(assembler, CONDITION_NOT_EQUAL);
+
+	// cmp dword [rdx + type], ELEMENT_NUMBER; jne slow
+	assemble_bytes(assembler, "\x81\xBA", 2);
+	assemble_u32(assembler, offsetof(Element, type));
+	assemble_u32(assembler, ELEMENT_NUMBER);
+	guards[1] = assemble_jump_ahead(assembler, CONDITION_NOT_EQUAL);
+
+	// mov rsi, [rsi + value]; mov rdx, [rdx + value]
+	assemble_bytes(assembler, "\x48\x8B\xB6", 3);
+	assemble_u32(assembler, offsetof(Element, value));
+	assemble_bytes(assembler, "\x48\x8B\x92", 3);
+	assemble_u32(assembler, offsetof(Element, value));
+
+	// cmp byte [rsi + is_double], 0; jcc slow
+	assemble_bytes(assembler, "\x80\xBE", 2);
+	assemble_u32(assembler, offsetof(Number, is_double));
+	assemble_bytes(assembler, "\x00", 1);
+	guards[2] = assemble_jump_ahead(assembler, is_double ? CONDITION_EQUAL : CONDITION_NOT_EQUAL);
+
+	// cmp byte [rdx + is_double], 0; jcc slow
+	assemble_bytes(assembler, "\x80\xBA", 2);
+	assemble_u32(assembler, offsetof(Number, is_double));
+	assemble_bytes(assembler, "\x00", 1);
+	guards[3] = assemble_jump_ahead(assembler, is_double ? CONDITION_EQUAL : CONDITION_NOT_EQUAL);
+}
+
+// function to remove the two values at the top of the value stack once assemble_load_numbers() has loaded them
+void assemble_drop_numbers(Assembler *assembler) {
+	// sub rcx, 2; mov [rax + length], rcx
+	assemble_bytes(assembler, "\x48\x83\xE9\x02\x48\x89\x88", 7);
+	assemble_u32(assembler, offsetof(Stack, length));
+}
+
+// function to compile an operator site, doing the arithmetic in machine code if the site has been quickened for an operation that can be done that way
+// the machine code still checks the types of the operands every time, and falls back to do_operate() if they don't match, which also deoptimises the site
+void assemble_operate(Assembler *assembler, Instruction *instruction) {
+	OperationType operation_type = instruction->operand;
+	bool is_double = instruction->opcode == OPCODE_OPERATE_DOUBLE;
+
+	if ((instruction->opcode != OPCODE_OPERATE_INTEGER && !is_double) || (operation_type != OPERATION_ADDITION && operation_type != OPERATION_SUBTRACTION && operation_type != OPERATION_MULTIPLICATION)) {
+		assemble_call(assembler, do_operate, instruction);
+		return;
+	}
+
+	size_t guards[4];
+	assemble_load_numbers(assembler, is_double, guards);
+
+	if (is_double) {
+		// movsd xmm0, [rsi + value_double]
+		assemble_bytes(assembler, "\xF2\x0F\x10\x86", 4);
+		assemble_u32(assembler, offsetof(Number, value_double));
+
+		// addsd, subsd or mulsd xmm0, [rdx + value_double]
+		unsigned char operation[] = {0xF2, 0x0F, operation_type == OPERATION_ADDITION ? 0x58 : operation_type == OPERATION_SUBTRACTION ? 0x5C : 0x59, 0x82};
+		assemble_bytes(assembler, operation, 4);
+		assemble_u32(assembler, offsetof(Number, value_double));
+	} else {
+		// mov rsi, [rsi + value_long]
+		assemble_bytes(assembler, "\x48\x8B\xB6", 3);
+		assemble_u32(assembler, offsetof(Number, value_long));
+
+		// add, sub or imul rsi, [rdx + value_long]
+		if (operation_type == OPERATION_MULTIPLICATION) {
+			assemble_bytes(assembler, "\x48\x0F\xAF\xB2", 4);
+		} else {
+			assemble_bytes(assembler, operation_type == OPERATION_ADDITION ? "\x48\x03\xB2" : "\x48\x2B\xB2", 3);
+		}
+		assemble_u32(assembler, offsetof(Number, value_long));
+	}
+
+	// the result is already in the argument register of the function that pushes it
+	assemble_drop_numbers(assembler);
+	assemble_call_with_vm(assembler, is_double ? (void*)jit_push_double : (void*)jit_push_integer);
+
+	size_t done = assemble_skip_ahead(assembler);
+
+	for (int i = 0; i < 4; i++) {
+		land_jump(assembler, guards[i]);
+	}
+	assemble_call(assembler, do_operate, instruction);
+
+	land_jump(assembler, done);
+}
+
+// function to compile an operator site that is followed by a conditional jump, comparing integers in machine code if the site has been quickened for integers
+// the jump target is taken from the jump instruction that was replaced, and the instructions after the jump instruction follow on if the jump isn't taken
+void assemble_operate_jump_if_false(Assembler *assembler, Instruction *instruction, size_t position) {
+	OperationType operation_type = instruction->operand;
+	size_t target = instruction[1].operand;
+
+	// the conditions that make each comparison false, as the comparison is made by the ucomisd instruction
+	Condition condition;
+	switch (operation_type) {
+		case OPERATION_LT:
+			condition = CONDITION_ABOVE_OR_EQUAL;
+			break;
+		case OPERATION_GT:
+			condition = CONDITION_BELOW_OR_EQUAL;
+			break;
+		case OPERATION_LTE:
+			condition = CONDITION_ABOVE;
+			break;
+		case OPERATION_GTE:
+			condition = CONDITION_BELOW;
+			break;
+		default:
+			condition = 0;
+			break;
+	}
+
+	if (instruction->opcode == OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE && condition != 0) {
+		size_t guards[4];
+		assemble_load_numbers(assembler, false, guards);
+
+		// comparisons are made between floating-point values, just as they are in perform_numeric_operation
+		// cvtsi2sd xmm0, [rsi + value_long]; cvtsi2sd xmm1, [rdx + value_long]
+		assemble_bytes(assembler, "\xF2\x48\x0F\x2A\x86", 5);
+		assemble_u32(assembler, offsetof(Number, value_long));
+		assemble_bytes(assembler, "\xF2\x48\x0F\x2A\x8A", 5);
+		assemble_u32(assembler, offsetof(Number, value_long));
+
+		assemble_drop_numbers(assembler);
+
+		// ucomisd xmm0, xmm1
+		assemble_bytes(assembler, "\x66\x0F\x2E\xC1", 4);
+		assemble_jump_if(assembler, condition, target);
+		assemble_jump(assembler, position + 2);
+
+		for (int i = 0; i < 4; i++) {
+			land_jump(assembler, guards[i]);
+		}
+	}
+
+	assemble_call(assembler, do_operate_jump_if_false, instruction);
+	assemble_jump_if_true(assembler, target);
+	assemble_jump(assembler, position + 2);
+}
+
+// function to compile a Loop to machine code, returning whether it could be compiled
+// most instructions become calls to functions that do their work, and jumps between instructions within the loop become jumps within the machine code
+// pushing constants and arithmetic and comparisons at operator sites that have been quickened are done in the machine code itself
+// instructions that the machine code can't handle, such as calls to compiled Closures, hand control back to run(), which re-enters the machine code the next time the loop jumps back to its condition
+bool compile_loop(Program *program, Loop *loop) {
+	size_t length = loop->end - loop->start + 1;
+
+	// each instruction needs at most three jumps to other instructions to be filled in
+	Assembler assembler = {NULL, 0, 0, program->code, loop->start, loop->end, malloc(3 * length * sizeof(Fixup)), 0};
+	size_t *positions = malloc(length * sizeof(size_t));
+
+	// push rbx; push r12; push r13; mov rbx, rdi
+	// the VM is kept in rbx, and pushing three registers keeps the stack aligned for calls
+	assemble_bytes(&assembler, "\x53\x41\x54\x41\x55\x48\x89\xFB", 8);
+
+	for (size_t i = loop->start; i <= loop->end; i++) {
+		Instruction *instruction = &program->code[i];
+		positions[i - loop->start] = assembler.length;
+
+		switch (instruction->opcode) {
+			case OPCODE_CONSTANT:
+				assemble_push_constant(&assembler, program->constants->content[instruction->operand]);
+				break;
+			case OPCODE_POP:
+				assemble_pop(&assembler);
+				break;
+			case OPCODE_OPERATE:
+			case OPCODE_OPERATE_INTEGER:
+			case OPCODE_OPERATE_DOUBLE:
+				assemble_operate(&assembler, instruction);
+				break;
+
+			case OPCODE_GET_VARIABLE:
+				assemble_call(&assembler, do_get_variable, instruction);
+				break;
+			case OPCODE_GET_LEXICAL:
+				assemble_call(&assembler, do_get_lexical, instruction);
+				break;
+			case OPCODE_ENTER_SEQUENCE:
+				assemble_call(&assembler, do_enter_sequence, instruction);
+				break;
+			case OPCODE_LEAVE_SEQUENCE:
+				assemble_call(&assembler, do_leave_sequence, instruction);
+				break;
+			case OPCODE_EXIT_SEQUENCE:
+				assemble_call(&assembler, do_exit_sequence, instruction);
+				break;
+			case OPCODE_ACCESS:
+				assemble_call(&assembler, do_access, instruction);
+				break;
+			case OPCODE_CLOSURE:
+				assemble_call(&assembler, do_closure, instruction);
+				break;
+			case OPCODE_PRINT:
+				assemble_call(&assembler, do_print, instruction);
+				break;
+			case OPCODE_LET:
+			case OPCODE_SET:
+				assemble_call(&assembler, do_set_variable, instruction);
+				break;
+			case OPCODE_LET_LEXICAL:
+			case OPCODE_SET_LEXICAL:
+				assemble_call(&assembler, do_set_lexical, instruction);
+				break;
+			case OPCODE_MUT:
+				assemble_call(&assembler, do_mut, instruction);
+				break;
+			case OPCODE_EDIT:
+				assemble_call(&assembler, do_edit, instruction);
+				break;
+			case OPCODE_EXPECT_SCOPE:
+			case OPCODE_EXPECT_STRING:
+			case OPCODE_EXPECT_CLOSURE:
+				assemble_call(&assembler, do_expect, instruction);
+				break;
+			case OPCODE_COLLECT:
+				assemble_call(&assembler, do_collect, instruction);
+				break;
+
+			case OPCODE_JUMP:
+				assemble_jump(&assembler, instruction->operand);
+				break;
+			case OPCODE_LOOP:
+			case OPCODE_NATIVE_LOOP:
+				assemble_jump(&assembler, ((Loop*)program->loops->content[instruction->operand])->start);
+				break;
+			case OPCODE_JUMP_IF_FALSE:
+				assemble_call(&assembler, do_jump_if_false, instruction);
+				assemble_jump_if_true(&assembler, instruction->operand);
+				break;
+			case OPCODE_AND:
+			case OPCODE_OR:
+				assemble_call(&assembler, do_short_circuit, instruction);
+				assemble_jump_if_true(&assembler, instruction->operand);
+				break;
+			case OPCODE_APPLY:
+				assemble_call(&assembler, do_apply, instruction);
+				assemble_exit_if_false(&assembler, i);
+				break;
+
+			// superinstructions skip over the instructions that they replaced
+			case OPCODE_UPDATE_LEXICAL:
+			case OPCODE_UPDATE_LEXICAL_INTEGER:
+				assemble_call(&assembler, update_lexical_variable, instruction);
+				assemble_jump(&assembler, i + 4);
+				break;
+			case OPCODE_APPLY_LEXICAL:
+				assemble_call(&assembler, do_apply_lexical, instruction);
+				assemble_exit_if_false(&assembler, i);
+				assemble_jump(&assembler, i + 2);
+				break;
+			case OPCODE_OPERATE_JUMP_IF_FALSE:
+			case OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE:
+				assemble_operate_jump_if_false(&assembler, instruction, i);
+				break;
+
+			// every other instruction is left to run()
+			default:
+				assemble_exit(&assembler, instruction);
+				break;
+		}
+	}
+
+	// pop r13; pop r12; pop rbx; ret
+	size_t end = assembler.length;
+	assemble_bytes(&assembler, "\x41\x5D\x41\x5C\x5B\xC3", 6);
+
+	// fill in the distance of every jump now that the position of every instruction is known
+	for (size_t i = 0; i < assembler.fixups_length; i++) {
+		Fixup *fixup = &assembler.fixups[i];
+		size_t target = fixup->target == SIZE_MAX ? end : positions[fixup->target - loop->start];
+		int32_t distance = target - (fixup->position + 4);
+		memcpy(assembler.content + fixup->position, &distance, 4);
+	}
+
+	free(positions);
+	free(assembler.fixups);
+
+	// copy the machine code into memory that can be executed
+	unsigned char *native = mmap(NULL, assembler.length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (native == MAP_FAILED) {
+		free(assembler.content);
+		return false;
+	}
+
+	memcpy(native, assembler.content, assembler.length);
+	free(assembler.content);
+
+	if (mprotect(native, assembler.length, PROT_READ | PROT_EXEC) != 0) {
+		munmap(native, assembler.length);
+		return false;
+	}
+
+	loop->native = native;
+	loop->native_size = assembler.length;
+
+	return true;
+}
+#else
+// function to compile a Loop to machine code, which is never possible on this platform
+bool compile_loop(Program *program, Loop *loop) {
+	return false;
+}
+#endif
+
+// the instruction loop jumps straight from the end of each instruction to the code for the next one when the compiler supports taking the address of a label
+// this gives every instruction its own jump, which the CPU can predict separately, instead of sending every instruction through the same switch statement
+// unoptimised builds keep the switch statement, since without optimisation the computed jumps make every instruction reload its state from memory
+#if defined(__GNUC__) && defined(__OPTIMIZE__)
+#define THREADED_DISPATCH
+#endif
+
+#ifdef THREADED_DISPATCH
+#define INSTRUCTION(opcode) label_##opcode
+#define DISPATCH() { instruction = ip++; goto *dispatch_table[instruction->opcode]; }
+#else
+#define INSTRUCTION(opcode) case opcode
+#define DISPATCH() continue
+#endif
+
+// function to execute the instructions of a Program, starting at a certain instruction
+// execution continues until the program halts or until a Closure call that was made from outside this function returns
+Element *run(VM *vm, Instruction *ip) {
+	Instruction *code = vm->program->code;
+	void **constants = vm->program->constants->content;
+
+	// get the innermost Scope of the current Closure call
+	Element *scopes = vm->scopes_stack->content[vm->scopes_stack->length - 1];
+
+	Instruction *instruction;
+
+#ifdef THREADED_DISPATCH
+	// table of the code for each opcode, which every instruction uses to jump to the next one
+	static void *dispatch_table[] = {
+		[OPCODE_CONSTANT] = &&label_OPCODE_CONSTANT,
+		[OPCODE_GET_VARIABLE] = &&label_OPCODE_GET_VARIABLE,
+		[OPCODE_GET_LEXICAL] = &&label_OPCODE_GET_LEXICAL,
+		[OPCODE_POP] = &&label_OPCODE_POP,
+		[OPCODE_ENTER_SEQUENCE] = &&label_OPCODE_ENTER_SEQUENCE,
+		[OPCODE_LEAVE_SEQUENCE] = &&label_OPCODE_LEAVE_SEQUENCE,
+		[OPCODE_EXIT_SEQUENCE] = &&label_OPCODE_EXIT_SEQUENCE,
+		[OPCODE_JUMP] = &&label_OPCODE_JUMP,
+		[OPCODE_JUMP_IF_FALSE] = &&label_OPCODE_JUMP_IF_FALSE,
+		[OPCODE_LOOP] = &&label_OPCODE_LOOP,
+		[OPCODE_AND] = &&label_OPCODE_AND,
+		[OPCODE_OR] = &&label_OPCODE_OR,
+		[OPCODE_OPERATE] = &&label_OPCODE_OPERATE,
+		[OPCODE_APPLY] = &&label_OPCODE_APPLY,
+		[OPCODE_TAIL_APPLY] = &&label_OPCODE_TAIL_APPLY,
+		[OPCODE_ACCESS] = &&label_OPCODE_ACCESS,
+		[OPCODE_CLOSURE] = &&label_OPCODE_CLOSURE,
+		[OPCODE_RETURN] = &&label_OPCODE_RETURN,
+		[OPCODE_PRINT] = &&label_OPCODE_PRINT,
+		[OPCODE_RAND] = &&label_OPCODE_RAND,
+		[OPCODE_LENGTH] = &&label_OPCODE_LENGTH,
+		[OPCODE_INPUT] = &&label_OPCODE_INPUT,
+		[OPCODE_READFILE] = &&label_OPCODE_READFILE,
+		[OPCODE_WRITEFILE] = &&label_OPCODE_WRITEFILE,
+		[OPCODE_LET] = &&label_OPCODE_LET,
+		[OPCODE_SET] = &&label_OPCODE_SET,
+		[OPCODE_LET_LEXICAL] = &&label_OPCODE_LET_LEXICAL,
+		[OPCODE_SET_LEXICAL] = &&label_OPCODE_SET_LEXICAL,
+		[OPCODE_MUT] = &&label_OPCODE_MUT,
+		[OPCODE_UNMAP] = &&label_OPCODE_UNMAP,
+		[OPCODE_EDIT] = &&label_OPCODE_EDIT,
+		[OPCODE_DELETE] = &&label_OPCODE_DELETE,
+		[OPCODE_KEYS] = &&label_OPCODE_KEYS,
+		[OPCODE_VALUES] = &&label_OPCODE_VALUES,
+		[OPCODE_EXPECT_SCOPE] = &&label_OPCODE_EXPECT_SCOPE,
+		[OPCODE_EXPECT_STRING] = &&label_OPCODE_EXPECT_STRING,
+		[OPCODE_EXPECT_CLOSURE] = &&label_OPCODE_EXPECT_CLOSURE,
+		[OPCODE_COLLECT] = &&label_OPCODE_COLLECT,
+		[OPCODE_FAIL] = &&label_OPCODE_FAIL,
+		[OPCODE_HALT] = &&label_OPCODE_HALT,
+		[OPCODE_UPDATE_LEXICAL] = &&label_OPCODE_UPDATE_LEXICAL,
+		[OPCODE_APPLY_LEXICAL] = &&label_OPCODE_APPLY_LEXICAL,
+		[OPCODE_OPERATE_JUMP_IF_FALSE] = &&label_OPCODE_OPERATE_JUMP_IF_FALSE,
+		[OPCODE_OPERATE_INTEGER] = &&label_OPCODE_OPERATE_INTEGER,
+		[OPCODE_OPERATE_DOUBLE] = &&label_OPCODE_OPERATE_DOUBLE,
+		[OPCODE_UPDATE_LEXICAL_INTEGER] = &&label_OPCODE_UPDATE_LEXICAL_INTEGER,
+		[OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE] = &&label_OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE,
+		[OPCODE_NATIVE_LOOP] = &&label_OPCODE_NATIVE_LOOP,
+	};
+
+	DISPATCH();
+#else
+	while (true) {
+		instruction = ip++;
+
+		switch (instruction->opcode) {
+#endif
+			INSTRUCTION(OPCODE_CONSTANT):
+				push_value(vm, constants[instruction->operand]);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_GET_VARIABLE):
+				push_value(vm, get_variable(constants[instruction->operand], scopes));
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_GET_LEXICAL):
+				push_value(vm, get_lexical_variable(scopes, vm->program->addresses->content[instruction->operand]));
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_POP):
+				pop_value(vm);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_ENTER_SEQUENCE):
+				// each sequence should have its own local scope, which becomes the innermost Scope until the sequence ends
+				scopes = make(ELEMENT_SCOPE, Scope_new(scopes), vm->heap);
+				vm->scopes_stack->content[vm->scopes_stack->length - 1] = scopes;
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_LEAVE_SEQUENCE):
+				// use the current Sequence's Scope object as the evaluation of the sequence, and restore the Scope it was made in as the innermost Scope
+				push_value(vm, scopes);
+				scopes = ((Scope*)scopes->value)->parent;
+				vm->scopes_stack->content[vm->scopes_stack->length - 1] = scopes;
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_EXIT_SEQUENCE):
+				// restore the Scope that the current Sequence was made in as the innermost Scope, leaving the returned value on the value stack
+				scopes = ((Scope*)scopes->value)->parent;
+				vm->scopes_stack->content[vm->scopes_stack->length - 1] = scopes;
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_JUMP):
+				ip = code + instruction->operand;
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_JUMP_IF_FALSE):
+				if (!value_is_truthy(pop_value(vm))) {
+					ip = code + instruction->operand;
+				}
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_LOOP):
+				{
+					Loop *loop = vm->program->loops->content[instruction->operand];
+					ip = code + loop->start;
+
+					// once the loop has run enough times, compile it to machine code, or turn this into an ordinary jump if it can't be compiled
+					if (vm->jit_threshold != 0 && ++loop->iterations >= vm->jit_threshold) {
+						if (compile_loop(vm->program, loop)) {
+							instruction->opcode = OPCODE_NATIVE_LOOP;
+						} else {
+							instruction->opcode = OPCODE_JUMP;
+							instruction->operand = loop->start;
+						}
+					}
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_NATIVE_LOOP):
+				{
+					// run the machine code of the loop from the start of its condition, then carry on from wherever it stopped
+					Loop *loop = vm->program->loops->content[instruction->operand];
+					ip = ((Instruction *(*)(VM*))loop->native)(vm);
+					scopes = vm->scopes_stack->content[vm->scopes_stack->length - 1];
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_AND):
+			INSTRUCTION(OPCODE_OR):
+				// if the first operand of && is falsy or the first operand of || is truthy, it is the result, so the second operand is skipped
+				// otherwise, the first operand is discarded and the second operand becomes the result
+				if ((instruction->opcode == OPCODE_AND) != value_is_truthy(peek_value(vm, 0))) {
+					ip = code + instruction->operand;
+				} else {
+					pop_value(vm);
+				}
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_OPERATE):
+				{
+					Element *element_b = pop_value(vm);
+					Element *element_a = pop_value(vm);
+					push_value(vm, operate_and_quicken(instruction, OPCODE_OPERATE_INTEGER, OPCODE_OPERATE_DOUBLE, instruction->operand, element_a, element_b, vm->heap));
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_OPERATE_INTEGER):
+				{
+					Element *element_b = pop_value(vm);
+					Element *element_a = pop_value(vm);
+					push_value(vm, operate_on_integer_elements(instruction, OPCODE_OPERATE, instruction->operand, element_a, element_b, vm->heap));
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_OPERATE_DOUBLE):
+				{
+					Element *element_b = pop_value(vm);
+					Element *element_a = pop_value(vm);
+					push_value(vm, operate_on_double_elements(instruction, OPCODE_OPERATE, instruction->operand, element_a, element_b, vm->heap));
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_APPLY):
+				{
+					Element *element_b = pop_value(vm);
+					Element *element_a = pop_value(vm);
+
+					if (element_a->type == ELEMENT_CLOSURE && ((Closure*)element_a->value)->code != NULL) {
+						// calls to compiled Closures continue within this loop so that they don't use up any more of the C stack
+						enter_closure(vm, element_a, element_b, ip);
+						ip = ((Closure*)element_a->value)->code;
+						scopes = vm->scopes_stack->content[vm->scopes_stack->length - 1];
+					} else {
+						push_value(vm, juxtapose(element_a, element_b, &vm->values, &vm->scopes_stack, vm->heap));
+					}
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_TAIL_APPLY):
+				{
+					Element *element_b = pop_value(vm);
+					Element *element_a = pop_value(vm);
+
+					if (element_a->type == ELEMENT_CLOSURE && ((Closure*)element_a->value)->code != NULL) {
+						// calls in tail position reuse the current call, so a Closure can call itself any number of times without using up any more memory
+						replace_closure(vm, element_a, element_b);
+						ip = ((Closure*)element_a->value)->code;
+						scopes = vm->scopes_stack->content[vm->scopes_stack->length - 1];
+					} else {
+						push_value(vm, juxtapose(element_a, element_b, &vm->values, &vm->scopes_stack, vm->heap));
+					}
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_ACCESS):
+				push_value(vm, access_cached_property(pop_value(vm), vm->program->caches->content[instruction->operand]));
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_CLOSURE):
+				{
+					Prototype *prototype = vm->program->prototypes->content[instruction->operand];
+
+					// the Closure keeps the innermost Scope so that it can use every Scope available where it was made
+					push_value(vm, make(ELEMENT_CLOSURE, Closure_new(prototype->expression, prototype->variable, scopes, code + prototype->entry), vm->heap));
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_RETURN):
+				{
+					// the call has ended, so restore the previous innermost Scope
+					vm->scopes_stack = Stack_pop(vm->scopes_stack);
+					scopes = vm->scopes_stack->content[vm->scopes_stack->length - 1];
+
+					Instruction *return_address = vm->returns->content[vm->returns->length - 1];
+					vm->returns = Stack_pop(vm->returns);
+
+					// if the call was made from outside this loop, hand the result back to the caller
+					if (return_address == NULL) {
+						return pop_value(vm);
+					}
+
+					ip = return_address;
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_PRINT):
+				print_value(pop_value(vm), 0, instruction->operand);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_RAND):
+				set_variable(constants[instruction->operand], make_random_number(vm->heap), scopes, true, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_LENGTH):
+				set_variable(constants[instruction->operand], measure_string(pop_value(vm), vm->heap), scopes, true, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_INPUT):
+				set_variable(constants[instruction->operand], read_input(vm->heap), scopes, true, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_READFILE):
+				set_variable(constants[instruction->operand], read_file_element(pop_value(vm), vm->heap), scopes, true, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_WRITEFILE):
+				{
+					Element *path = pop_value(vm);
+					Element *new_contents = pop_value(vm);
+					set_variable(constants[instruction->operand], write_file_element(new_contents, path, vm->heap), scopes, true, vm->heap);
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_LET):
+			INSTRUCTION(OPCODE_SET):
+				set_variable(constants[instruction->operand], pop_value(vm), scopes, instruction->opcode == OPCODE_LET, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_LET_LEXICAL):
+			INSTRUCTION(OPCODE_SET_LEXICAL):
+				set_lexical_variable(scopes, vm->program->addresses->content[instruction->operand], pop_value(vm), instruction->opcode == OPCODE_LET_LEXICAL, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_MUT):
+				{
+					Element *value = pop_value(vm);
+					Element *key = pop_value(vm);
+					Element *subject = pop_value(vm);
+					set_scope_mapping_dynamically(subject, key, value, vm->heap);
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_UNMAP):
+				{
+					Element *key = pop_value(vm);
+					Element *subject = pop_value(vm);
+					subject->value = delete_scope_mapping(subject->value, key);
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_EDIT):
+				{
+					Element *value = pop_value(vm);
+					Element *subject = pop_value(vm);
+					edit_cached_property(subject, vm->program->caches->content[instruction->operand], value, vm->heap);
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_DELETE):
+				{
+					Element *subject = pop_value(vm);
+					subject->value = delete_scope_mapping(subject->value, constants[instruction->operand]);
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_KEYS):
+			INSTRUCTION(OPCODE_VALUES):
+				iterate_scope(vm, instruction->opcode == OPCODE_KEYS);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_EXPECT_SCOPE):
+				if (peek_value(vm, 0)->type != ELEMENT_SCOPE) {
+					whoops(constants[instruction->operand]);
+				}
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_EXPECT_STRING):
+				if (peek_value(vm, 0)->type != ELEMENT_STRING) {
+					whoops(constants[instruction->operand]);
+				}
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_EXPECT_CLOSURE):
+				if (peek_value(vm, 0)->type != ELEMENT_CLOSURE) {
+					whoops(constants[instruction->operand]);
+				}
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_COLLECT):
+				garbage_collect_if_due(NULL, &vm->values, &vm->scopes_stack, vm->heap);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_FAIL):
+				whoops(constants[instruction->operand]);
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_UPDATE_LEXICAL):
+			INSTRUCTION(OPCODE_UPDATE_LEXICAL_INTEGER):
+				// skip over the instructions that were replaced
+				update_lexical_variable(vm, instruction);
+				ip += 3;
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_APPLY_LEXICAL):
+				{
+					Element *element_b = get_lexical_variable(scopes, vm->program->addresses->content[instruction->operand]);
+					Element *element_a = pop_value(vm);
+
+					// skip over the application instruction that was replaced
+					ip++;
+
+					if (element_a->type == ELEMENT_CLOSURE && ((Closure*)element_a->value)->code != NULL) {
+						enter_closure(vm, element_a, element_b, ip);
+						ip = ((Closure*)element_a->value)->code;
+						scopes = vm->scopes_stack->content[vm->scopes_stack->length - 1];
+					} else {
+						push_value(vm, juxtapose(element_a, element_b, &vm->values, &vm->scopes_stack, vm->heap));
+					}
+				};
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_OPERATE_JUMP_IF_FALSE):
+			INSTRUCTION(OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE):
+				// the jump target is taken from the jump instruction that was replaced, which is skipped over if the result is truthy
+				if (operate_and_test(vm, instruction)) {
+					ip++;
+				} else {
+					ip = code + ip->operand;
+				}
+				DISPATCH();
+
+			INSTRUCTION(OPCODE_HALT):
+				return NULL;
+#ifndef THREADED_DISPATCH
+		}
+	}
+#endif
+}
+
+// buffer that output to the console is collected in before it is written
+char output_buffer[65536];
+
+// procedure to seed the RNG using the system clock and CPU tick count, then generate one random number to shuffle it up a little
+// this seems to give pretty good random numbers
+void seed_rng() {
+	srand(time(NULL) * clock());
+	rand();
+}
+
+// function to mark every Element on a heap as permanently non-garbage, for heaps whose Elements are kept until the script finishes and are never garbage collected
+// since the garbage collector stops at any Element that has already been marked, it never has to trace through them
+void make_permanent(Heap *heap) {
+	for (size_t i = 0; i < heap->young->length; i++) {
+		((Element*)heap->young->content[i])->gc_checked = true;
+	}
+}
+
+// function to run a script on a new heap, either by evaluating its syntax tree directly or by running the Program that it was compiled to with a certain function
+// the syntax tree is only used if there is no Program
+void run_script(Element *ast_root, Program *program, Element *(*run_function)(VM*, Instruction*), Options *options) {
+	// make a new heap to keep track of all the elements that will be made while the script runs
+	// this will be useful for garbage collection later
+	Heap *heap = Heap_new(options->gc_budget, options->gc_growth);
+
+	// make a stack to temporarily keep track of certain objects so they don't get garbage collected prematurely
+	Stack *keep_stack = Stack_new();
+
+	// make a stack to keep track of the innermost Scope of each Closure call so they don't get garbage collected prematurely
+	Stack *scopes_stack = Stack_new();
+
+	// there are no Scopes before the script starts
+	scopes_stack = Stack_push(scopes_stack, NULL);
+
+	if (program == NULL) {
+		evaluate(ast_root, &keep_stack, &scopes_stack, heap);
+	} else {
+		// the keep stack doubles as the value stack of the virtual machine
+		VM vm = {program, keep_stack, scopes_stack, Stack_new(), heap, options->jit_threshold, run_function};
+		run_function(&vm, program->code);
+
+		keep_stack = vm.values;
+		scopes_stack = vm.scopes_stack;
+		free(vm.returns);
+	}
+
+	// we no longer need these stacks after the evaluation so they can be safely freed
+	free(keep_stack);
+	free(scopes_stack);
+
+	if (options->gc_stats) {
+		// keep the statistics after everything that the script printed
+		fflush(stdout);
+
+		fprintf(stderr, "minor garbage collections: %zu\nmajor garbage collections: %zu\nelements allocated: %zu\nelements promoted: %zu\nelements freed: %zu\npeak heap size: %zu\n", heap->minor_collections, heap->major_collections, heap->allocated, heap->promoted, heap->freed, heap->peak);
+	}
+
+	// clean up everything that is left on the heap indiscriminately
+	Heap_free(heap);
+}
+
+// function to release the memory that the runtime keeps between scripts, once every heap has been freed
+void free_runtime() {
+	// every Element and value has been given back to its pool by now, so the pools can release their memory
+	Pool_destroy(&element_pool);
+	Pool_destroy(&number_element_pool);
+	Pool_destroy(&operation_pool);
+	Pool_destroy(&scope_pool);
+	Pool_destroy(&closure_pool);
+
+	free_shapes();
+}
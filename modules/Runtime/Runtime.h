@@ -0,0 +1,686 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "String.h"
+#include "Stack.h"
+#include "Pool.h"
+
+// loops are only compiled to machine code on x86-64 Linux, and are always interpreted everywhere else
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_SUPPORTED
+#endif
+
+// numeric type that can represent either long integer or double-precision floating-point values
+typedef struct {
+	bool is_double;
+	union {
+		long value_long;
+		double value_double;
+	};
+} Number;
+
+// enumeration type used to represent the type of an Element
+typedef enum {
+	ELEMENT_NOTHING,
+
+	ELEMENT_TERMINATOR,
+	ELEMENT_BRACKET,
+	ELEMENT_BRACE,
+	ELEMENT_COMMAND,
+
+	ELEMENT_NULL,
+	ELEMENT_VARIABLE,
+	ELEMENT_OPERATION,
+	ELEMENT_STRING,
+	ELEMENT_NUMBER,
+
+	ELEMENT_SEQUENCE,
+
+	ELEMENT_SCOPE,
+	ELEMENT_CLOSURE,
+} ElementType;
+
+// type used to store any value that can be encountered by the language, as well as its type and garbage-collection status
+typedef struct {
+	ElementType type;
+	bool gc_checked;
+
+	// whether the Element has survived a garbage collection and moved to the old generation
+	bool gc_old;
+
+	// whether the Element is in the old generation and has been changed since the last garbage collection
+	bool gc_remembered;
+
+	void *value;
+} Element;
+
+// enumeration type used to represent the type of an Operation
+typedef enum {
+	OPERATION_JUXTAPOSITION,
+	OPERATION_ACCESS,
+	OPERATION_POW,
+	OPERATION_MULTIPLICATION,
+	OPERATION_DIVISION,
+	OPERATION_REMAINDER,
+	OPERATION_ADDITION,
+	OPERATION_SUBTRACTION,
+	OPERATION_SHIFT_LEFT,
+	OPERATION_SHIFT_RIGHT,
+	OPERATION_SUBL,
+	OPERATION_SUBG,
+	OPERATION_CHAR_AT,
+	OPERATION_CHAR_APPEND,
+	OPERATION_LT,
+	OPERATION_GT,
+	OPERATION_LTE,
+	OPERATION_GTE,
+	OPERATION_EQUALITY,
+	OPERATION_INEQUALITY,
+	OPERATION_LIKENESS,
+	OPERATION_BWAND,
+	OPERATION_BWXOR,
+	OPERATION_BWOR,
+	OPERATION_XOR,
+	OPERATION_AND,
+	OPERATION_OR,
+	OPERATION_CLOSURE,
+} OperationType;
+
+// enumeration type used to represent the command of a statement
+typedef enum {
+	COMMAND_DO,
+	COMMAND_RETURN,
+	COMMAND_PRINT,
+	COMMAND_SHOW,
+	COMMAND_WHOOPS,
+	COMMAND_RAND,
+	COMMAND_LENGTH,
+	COMMAND_INPUT,
+	COMMAND_READFILE,
+	COMMAND_WRITEFILE,
+	COMMAND_IF,
+	COMMAND_WHILE,
+	COMMAND_LET,
+	COMMAND_SET,
+	COMMAND_MUT,
+	COMMAND_UNMAP,
+	COMMAND_EDIT,
+	COMMAND_DELETE,
+	COMMAND_KEYS,
+	COMMAND_VALUES,
+} CommandType;
+
+// type used to represent an operation that is to be performed on two values
+typedef struct {
+	OperationType type;
+	Element *element_a;
+	Element *element_b;
+} Operation;
+
+// type used to represent an association between a key and a value
+// a Map whose key is NULL is a leftover from a deleted mapping and should be skipped over
+typedef struct {
+	Element *key;
+	Element *value;
+} Map;
+
+// type used to describe the layout of Scopes that have had the same property names added to them in the same order, also known as a hidden class
+// since a Scope of a certain Shape always has each of its properties at the same position in its list of mappings, the position of a property can be remembered and reused for any other Scope of that Shape
+typedef struct Shape {
+	// the property name that was added to make this Shape, which is at the last position in the list of mappings, or NULL for the empty Shape
+	Element *key;
+
+	// the number of mappings in a Scope of this Shape
+	size_t length;
+
+	// the Shapes made by adding another property name to Scopes of this Shape
+	Stack *transitions;
+} Shape;
+
+// the number of mappings a Scope can hold before it is given a hash index, since searching through small Scopes directly is faster than hashing
+#define SCOPE_INDEX_THRESHOLD 8
+
+// type used to represent a scope of variables or an object with properties depending on usage
+typedef struct {
+	// the number of mappings in the Scope
+	size_t length;
+
+	// the list of mappings in order of their addition to the Scope, including any leftovers from deleted mappings
+	size_t used;
+	size_t capacity;
+	Map *maps;
+
+	// open-addressing hash index used to find the position of a key in the list of mappings
+	// each bucket stores the position of a mapping plus one, so that an empty bucket can be represented by zero
+	// keys in the dense part of the Scope are left out of the index, so the number of positions that have been added to it is counted separately
+	size_t *index;
+	size_t index_capacity;
+	size_t indexed;
+
+	// the positions in the list of mappings of the keys 0, 1, 2 and so on, for as long as they are added without skipping any
+	// array-like Scopes are mostly made up of these keys, which can be found straight away without hashing or comparing them
+	// a deleted key is represented by a position of SIZE_MAX, so that the keys after it can stay where they are
+	size_t *dense;
+	size_t dense_length;
+	size_t dense_capacity;
+
+	// the Scope that this Scope was made in, which is searched for any variables that this Scope doesn't have
+	// Scopes are linked together like this so that Closures can share the Scopes they were made in instead of copying them
+	Element *parent;
+
+	// whether a statement such as 'mut' or 'edit' has added a key to the Scope that wasn't defined by the Scope's own sequence
+	// compiled variable lookups can't skip over Scopes like this, since they might have gained a variable that would otherwise be found further out
+	bool changed_dynamically;
+
+	// the Shape of the Scope, or NULL if it has a key that isn't a property name or has had a mapping deleted, since the positions of its mappings then can't be predicted
+	Shape *shape;
+} Scope;
+
+// enumeration type used to represent the type of a bytecode instruction
+typedef enum {
+	OPCODE_CONSTANT,
+	OPCODE_GET_VARIABLE,
+	OPCODE_GET_LEXICAL,
+	OPCODE_POP,
+	OPCODE_ENTER_SEQUENCE,
+	OPCODE_LEAVE_SEQUENCE,
+	OPCODE_EXIT_SEQUENCE,
+	OPCODE_JUMP,
+	OPCODE_JUMP_IF_FALSE,
+	OPCODE_LOOP,
+	OPCODE_AND,
+	OPCODE_OR,
+	OPCODE_OPERATE,
+	OPCODE_APPLY,
+	OPCODE_TAIL_APPLY,
+	OPCODE_ACCESS,
+	OPCODE_CLOSURE,
+	OPCODE_RETURN,
+	OPCODE_PRINT,
+	OPCODE_RAND,
+	OPCODE_LENGTH,
+	OPCODE_INPUT,
+	OPCODE_READFILE,
+	OPCODE_WRITEFILE,
+	OPCODE_LET,
+	OPCODE_SET,
+	OPCODE_LET_LEXICAL,
+	OPCODE_SET_LEXICAL,
+	OPCODE_MUT,
+	OPCODE_UNMAP,
+	OPCODE_EDIT,
+	OPCODE_DELETE,
+	OPCODE_KEYS,
+	OPCODE_VALUES,
+	OPCODE_EXPECT_SCOPE,
+	OPCODE_EXPECT_STRING,
+	OPCODE_EXPECT_CLOSURE,
+	OPCODE_COLLECT,
+	OPCODE_FAIL,
+	OPCODE_HALT,
+
+	// superinstructions, which do the work of a common sequence of instructions in one go
+	// each one replaces the first instruction of its sequence and reads the operands of the instructions after it, which are left in place and skipped over
+	OPCODE_UPDATE_LEXICAL,
+	OPCODE_APPLY_LEXICAL,
+	OPCODE_OPERATE_JUMP_IF_FALSE,
+
+	// quickened instructions, which an operator site is rewritten into once it has seen the types of its operands
+	// each one only handles operands of one type and rewrites itself back into its generic instruction when it is given anything else
+	OPCODE_OPERATE_INTEGER,
+	OPCODE_OPERATE_DOUBLE,
+	OPCODE_UPDATE_LEXICAL_INTEGER,
+	OPCODE_OPERATE_INTEGER_JUMP_IF_FALSE,
+
+	// the instruction that a loop is rewritten into once it has been compiled to machine code
+	OPCODE_NATIVE_LOOP,
+} Opcode;
+
+// type used to represent a single bytecode instruction
+// the meaning of the operand depends on the opcode; it may be a constant index, a jump target, an operation type or a flag
+typedef struct {
+	Opcode opcode;
+	unsigned int operand;
+} Instruction;
+
+// type used to represent a Closure, which is a function that stores within itself the Scopes surrounding it
+// this means that variables in the Scopes in which the Closure was created can be accessed by the Closure when it is called
+typedef struct {
+	Element *expression;
+	Element *variable;
+	Element *scopes;
+
+	// the compiled bytecode of the Closure's expression, or NULL if the Closure is to be evaluated by walking the syntax tree
+	Instruction *code;
+} Closure;
+
+// type used to keep track of all the Elements stored on the heap, and to decide when they should be garbage collected
+// Elements start out in the young generation and move to the old generation once they survive a garbage collection
+// old Elements always stay marked as non-garbage between garbage collections, so that a minor garbage collection stops tracing whenever it reaches one
+typedef struct {
+	// list of every Element that has been made since the last garbage collection
+	Stack *young;
+
+	// list of every Element that has survived a garbage collection and not yet been free'd
+	Stack *old;
+
+	// list of old Elements that have been changed to refer to other Elements since the last garbage collection
+	Stack *remembered;
+
+	// number of Elements that the old generation may hold before the next major garbage collection is due
+	size_t threshold;
+
+	// the number of new Elements that can be made between minor garbage collections
+	size_t budget;
+
+	// the number of Elements that can be added to the old generation between major garbage collections for each Element that survived the last one
+	double growth;
+
+	// statistics about the work done by the garbage collector
+	size_t minor_collections;
+	size_t major_collections;
+	size_t allocated;
+	size_t promoted;
+	size_t freed;
+	size_t peak;
+} Heap;
+
+// type used to store a number Element together with its Number, so that both can be made in a single allocation
+typedef struct {
+	Element element;
+	Number number;
+} NumberElement;
+
+// the range of integers that are common enough to be shared between all uses instead of being made every time they are needed
+#define SMALL_NUMBER_MIN -128
+
+#define SMALL_NUMBER_MAX 1023
+
+// type used to describe the Scope that a sequence or a Closure call will make when it is executed, as far as can be told without executing it
+typedef struct StaticScope {
+	// the keys that the Scope's own statements define, in the order that they will be added to the Scope
+	Stack *names;
+
+	// the StaticScope describing the Scope that this one will be made in, or NULL for the outermost Scope
+	struct StaticScope *parent;
+} StaticScope;
+
+// type used to describe where a variable is expected to be found when it is looked up
+// the variable should be in the Scope that is a certain number of parents out from the innermost Scope, at a certain position in its list of mappings
+typedef struct {
+	Element *name;
+	size_t depth;
+	size_t slot;
+} Address;
+
+// the number of different Shapes that an InlineCache can remember at once
+#define INLINE_CACHE_SIZE 4
+
+// type used to remember where a property was found in the Scopes that a certain instruction has been used with, so that the property doesn't have to be searched for again
+typedef struct {
+	Element *name;
+
+	// the Shapes of the Scopes that the property has been found in and the position of the property in each of them
+	Shape *shapes[INLINE_CACHE_SIZE];
+	size_t slots[INLINE_CACHE_SIZE];
+	size_t length;
+
+	// the entry to replace next once every entry has been used
+	size_t next;
+} InlineCache;
+
+// type used to keep track of a 'while' loop in a Program so that it can be compiled to machine code once it has run enough times
+typedef struct {
+	// the positions of the first instruction of the loop's condition and of the instruction that jumps back to it
+	size_t start;
+	size_t end;
+
+	// the number of times that the loop has jumped back to its condition
+	size_t iterations;
+
+	// the machine code of the loop, which is NULL until the loop has been compiled
+	// it runs the loop until the loop is left or an instruction that it can't handle is reached, then returns the instruction to continue from
+	unsigned char *native;
+	size_t native_size;
+} Loop;
+
+// type used to store a compiled program, which is a flat list of instructions along with the constants and closure prototypes that they refer to
+typedef struct {
+	Instruction *code;
+	size_t length;
+	size_t capacity;
+
+	// constants can be Elements from the abstract syntax tree or error message strings, depending on the instruction that refers to them
+	Stack *constants;
+
+	Stack *prototypes;
+
+	// the Addresses of the variables that were resolved while compiling, which are referred to by lexical instructions
+	Stack *addresses;
+
+	// the InlineCaches of the instructions that access or edit properties
+	Stack *caches;
+
+	// the Loops that the loop instructions refer to
+	Stack *loops;
+
+	// every StaticScope made while compiling, along with the StaticScope of the code that is currently being compiled
+	Stack *static_scopes;
+	StaticScope *scope;
+} Program;
+
+// type used to describe a Closure expression that has been found in the abstract syntax tree so that its body can be compiled separately
+typedef struct {
+	Element *expression;
+	Element *variable;
+
+	// the StaticScope of the code in which the Closure expression was found
+	StaticScope *scope;
+
+	// the position of the first instruction of the compiled expression
+	size_t entry;
+} Prototype;
+
+// type used to store the state of the virtual machine that executes a compiled Program
+typedef struct VM {
+	Program *program;
+
+	// the values that are currently being operated on, which are also protected from garbage collection
+	Stack *values;
+
+	// the innermost Scope of each Closure call that is currently in progress
+	Stack *scopes_stack;
+
+	// the instruction to return to at the end of each Closure call, or NULL if the call was made from outside the instruction loop
+	Stack *returns;
+
+	Heap *heap;
+
+	// the number of times that a loop has to run before it is compiled to machine code, or 0 if loops should never be compiled
+	size_t jit_threshold;
+
+	// the function that runs the instructions of the Program, which is run() unless the Program has been compiled to C
+	Element *(*run)(struct VM*, Instruction*);
+} VM;
+
+// type used to store the settings chosen by the user on the command line
+typedef struct {
+	// whether the syntax tree should be evaluated directly instead of being compiled to bytecode first
+	bool tree_walk;
+
+	// the number of new Elements that can always be made between garbage collections
+	size_t gc_budget;
+
+	// the number of new Elements that can be made between garbage collections for each Element that survived the last one
+	double gc_growth;
+
+	// whether statistics about garbage collection should be printed once the script finishes
+	bool gc_stats;
+
+	// how output to the console should be buffered, either _IONBF, _IOLBF or _IOFBF
+	int buffering;
+
+	// the number of times that a loop has to run before it is compiled to machine code, or 0 if loops should never be compiled
+	size_t jit_threshold;
+
+	// whether the script should be run both with and without machine code to check that it behaves the same way both times
+	bool conformance;
+} Options;
+
+// the number of times that a loop has to run before it is compiled to machine code, unless loops should never be compiled
+#define JIT_THRESHOLD 100
+
+extern char *const COMMAND_NAMES[COMMAND_VALUES + 1];
+
+extern char output_buffer[65536];
+
+void whoops(char*);
+
+String *read_file(char*);
+
+bool write_file(char*, String*);
+
+Element *Element_new(ElementType, void*);
+
+Operation *Operation_new(OperationType, Element*, Element*);
+
+Number perform_numeric_operation(OperationType, Number*, Number*);
+
+bool operate_on_integers(OperationType, long, long, Number*);
+
+bool operate_on_doubles(OperationType, double, double, Number*);
+
+Shape *add_shape_key(Shape*, Element*);
+
+void free_shapes();
+
+Scope *Scope_new(Element*);
+
+void Scope_free(Scope*);
+
+bool compare_elements(Element*, Element*);
+
+uint64_t mix_hash(uint64_t);
+
+uint64_t hash_element(Element*);
+
+long dense_scope_key(Element*);
+
+bool in_dense_scope_part(Scope*, Element*);
+
+void index_scope_mapping(Scope*, size_t);
+
+void compact_scope(Scope*);
+
+size_t find_scope_mapping(Scope*, Element*);
+
+Scope *set_scope_mapping(Scope*, Element*, Element*);
+
+Element *get_scope_mapping(Scope*, Element*);
+
+bool check_scope_mapping(Scope*, Element*);
+
+Scope *delete_scope_mapping(Scope*, Element*);
+
+void print_value(Element*, int, bool);
+
+bool value_is_truthy(Element*);
+
+Closure *Closure_new(Element*, Element*, Element*, Instruction*);
+
+Heap *Heap_new(size_t, double);
+
+Element *add_to_heap(Element*, Heap*);
+
+Element *make(ElementType, void*, Heap*);
+
+Element *make_number(Number, Heap*);
+
+void write_barrier(Element*, Heap*);
+
+void garbage_check(Element*);
+
+void nuke(Element*);
+
+void garbage_check_roots(Element*, Stack**, Stack**);
+
+void sweep_young_generation(Heap*);
+
+void garbage_collect_minor(Element*, Stack**, Stack**, Heap*);
+
+void garbage_collect(Element*, Stack**, Stack**, Heap*);
+
+void Heap_free(Heap*);
+
+void garbage_collect_if_due(Element*, Stack**, Stack**, Heap*);
+
+void set_variable(Element*, Element*, Element*, bool, Heap*);
+
+void set_scope_mapping_dynamically(Element*, Element*, Element*, Heap*);
+
+Element *get_variable(Element*, Element*);
+
+Element *prepare_closure_scopes(Closure*, Element*, Heap*);
+
+Element *perform_operation(OperationType, Element*, Element*, Heap*);
+
+Element *access_property(Element*, Element*);
+
+Element *make_random_number(Heap*);
+
+Element *measure_string(Element*, Heap*);
+
+Element *read_input(Heap*);
+
+Element *read_file_element(Element*, Heap*);
+
+Element *write_file_element(Element*, Element*, Heap*);
+
+Element *juxtapose(Element*, Element*, Stack**, Stack**, Heap*);
+
+Element *evaluate(Element*, Stack**, Stack**, Heap*);
+
+Element *evaluate_tail(Element*, Stack**, Stack**, Heap*, Element**, Element**);
+
+Program *Program_new();
+
+void Program_free(Program*);
+
+size_t emit(Program*, Opcode, size_t);
+
+size_t add_constant(Program*, void*);
+
+size_t add_inline_cache(Program*, Element*);
+
+size_t add_address(Program*, Element*, size_t, size_t);
+
+size_t add_prototype(Program*, Element*, Element*, size_t);
+
+size_t add_loop(Program*, size_t);
+
+void push_value(VM*, Element*);
+
+Element *pop_value(VM*);
+
+Element *peek_value(VM*, size_t);
+
+void enter_closure(VM*, Element*, Element*, Instruction*);
+
+void replace_closure(VM*, Element*, Element*);
+
+Element *apply(VM*, Element*, Element*);
+
+void iterate_scope(VM*, bool);
+
+size_t find_cached_property(Scope*, InlineCache*);
+
+Element *access_cached_property(Element*, InlineCache*);
+
+void edit_cached_property(Element*, InlineCache*, Element*, Heap*);
+
+Element *find_lexical_scope(Element*, Address*);
+
+Element *get_lexical_variable(Element*, Address*);
+
+void set_lexical_variable(Element*, Address*, Element*, bool, Heap*);
+
+bool is_integer(Element*);
+
+bool is_double(Element*);
+
+Element *operate_and_quicken(Instruction*, Opcode, Opcode, OperationType, Element*, Element*, Heap*);
+
+Element *operate_on_integer_elements(Instruction*, Opcode, OperationType, Element*, Element*, Heap*);
+
+Element *operate_on_double_elements(Instruction*, Opcode, OperationType, Element*, Element*, Heap*);
+
+Element *operate_at_site(Instruction*, Element*, Element*, Heap*);
+
+Element *innermost_scope(VM*);
+
+void update_lexical_variable(VM*, Instruction*);
+
+bool operate_and_test(VM*, Instruction*);
+
+void do_get_variable(VM*, Instruction*);
+
+void do_get_lexical(VM*, Instruction*);
+
+void do_enter_sequence(VM*, Instruction*);
+
+void do_leave_sequence(VM*, Instruction*);
+
+void do_exit_sequence(VM*, Instruction*);
+
+void do_operate(VM*, Instruction*);
+
+void do_access(VM*, Instruction*);
+
+void do_closure(VM*, Instruction*);
+
+void do_print(VM*, Instruction*);
+
+void do_set_variable(VM*, Instruction*);
+
+void do_set_lexical(VM*, Instruction*);
+
+void do_mut(VM*, Instruction*);
+
+void do_edit(VM*, Instruction*);
+
+void do_expect(VM*, Instruction*);
+
+void do_collect(VM*, Instruction*);
+
+void do_rand(VM*, Instruction*);
+
+void do_length(VM*, Instruction*);
+
+void do_input(VM*, Instruction*);
+
+void do_readfile(VM*, Instruction*);
+
+void do_writefile(VM*, Instruction*);
+
+void do_unmap(VM*, Instruction*);
+
+void do_delete(VM*, Instruction*);
+
+void do_iterate(VM*, Instruction*);
+
+void do_fail(VM*, Instruction*);
+
+bool do_jump_if_false(VM*, Instruction*);
+
+bool do_short_circuit(VM*, Instruction*);
+
+bool do_operate_jump_if_false(VM*, Instruction*);
+
+bool do_apply(VM*, Instruction*);
+
+bool do_apply_lexical(VM*, Instruction*);
+
+Instruction *do_call(VM*, Instruction*);
+
+Instruction *do_call_lexical(VM*, Instruction*);
+
+Instruction *do_tail_call(VM*, Instruction*);
+
+Instruction *do_return(VM*, Instruction*);
+
+Element *run(VM*, Instruction*);
+
+void seed_rng();
+
+void make_permanent(Heap*);
+
+void run_script(Element*, Program*, Element *(*)(VM*, Instruction*), Options*);
+
+void free_runtime();
+
+#endif
@@ -3,41 +3,113 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "Stack.h"
 
+// the number of items that a Stack always has room for, so that small Stacks never need to be reallocated
+#define STACK_MINIMUM_CAPACITY 8
+
+// function to change the number of items that a Stack has room for
+Stack *Stack_resize(Stack *stack, size_t capacity) {
+	stack = realloc(stack, sizeof(Stack) + capacity * sizeof(void*));
+	stack->capacity = capacity;
+	return stack;
+}
+
+// function to give back some of a Stack's memory once it is mostly unused
+// the Stack is only shrunk once it is less than a quarter full, and then only to half its capacity, so that pushing and popping around the same length doesn't keep reallocating it
+Stack *Stack_shrink(Stack *stack) {
+	if (stack->capacity > STACK_MINIMUM_CAPACITY && stack->length < stack->capacity / 4) {
+		size_t capacity = stack->capacity / 2;
+
+		// a Stack that has had lots of items removed in one go can be shrunk further straight away
+		while (capacity > STACK_MINIMUM_CAPACITY && stack->length < capacity / 4) {
+			capacity /= 2;
+		}
+
+		if (capacity < STACK_MINIMUM_CAPACITY) {
+			capacity = STACK_MINIMUM_CAPACITY;
+		}
+
+		stack = Stack_resize(stack, capacity);
+	}
+
+	return stack;
+}
+
 // function to make and initialise a new Stack
 Stack *Stack_new() {
-	Stack *new_stack = malloc(sizeof(Stack));
+	Stack *new_stack = malloc(sizeof(Stack) + STACK_MINIMUM_CAPACITY * sizeof(void*));
 	new_stack->length = 0;
+	new_stack->capacity = STACK_MINIMUM_CAPACITY;
 	return new_stack;
 }
 
-// function to add an item to the top of an existing Stack by allocating more memory for it
+// function to make sure that a Stack has room for a certain number of items without being reallocated
+// the capacity is at least doubled whenever it has to grow, so that growing a Stack one item at a time takes amortised constant time
+Stack *Stack_reserve(Stack *stack, size_t capacity) {
+	if (capacity > stack->capacity) {
+		size_t new_capacity = stack->capacity * 2;
+		if (new_capacity < capacity) {
+			new_capacity = capacity;
+		}
+
+		stack = Stack_resize(stack, new_capacity);
+	}
+
+	return stack;
+}
+
+// function to add an item to the top of an existing Stack, allocating more memory for it if there isn't any room left
 Stack *Stack_push(Stack *stack, void *new_element) {
-	stack = realloc(stack, sizeof(Stack) + (stack->length + 1) * sizeof(void*));
+	if (stack->length == stack->capacity) {
+		stack = Stack_reserve(stack, stack->length + 1);
+	}
+
 	stack->content[stack->length] = new_element;
 	stack->length++;
 	return stack;
 }
 
-// function to remove the top item from a Stack by deallocating some of the Stack's memory
+// function to add every item in another Stack to the top of an existing Stack in one go
+Stack *Stack_append(Stack *stack, Stack *items) {
+	stack = Stack_reserve(stack, stack->length + items->length);
+	memcpy(&stack->content[stack->length], items->content, items->length * sizeof(void*));
+	stack->length += items->length;
+	return stack;
+}
+
+// function to make a new Stack with the same items as an existing Stack
+Stack *Stack_copy(Stack *stack) {
+	return Stack_append(Stack_new(), stack);
+}
+
+// function to remove the top item from a Stack
 Stack *Stack_pop(Stack *stack) {
 	stack->length--;
-	stack = realloc(stack, sizeof(Stack) + stack->length * sizeof(void*));
-	return stack;
+	return Stack_shrink(stack);
 }
 
 // function to delete an item from a stack at an arbitrary position
 Stack *Stack_delete(Stack *stack, size_t index) {
 	// shift every item after doomed item back one position
-	for (size_t i = index + 1; i < stack->length; i++) {
-		stack->content[i - 1] = stack->content[i];
-	}
+	memmove(&stack->content[index], &stack->content[index + 1], (stack->length - index - 1) * sizeof(void*));
 
 	// change the length of the stack to reflect the updated contents
 	stack->length--;
-	stack = realloc(stack, sizeof(Stack) + stack->length * sizeof(void*));
 
-	return stack;
+	return Stack_shrink(stack);
+}
+
+// function to remove every item from a Stack past a certain length in one go
+Stack *Stack_truncate(Stack *stack, size_t length) {
+	// only shrink the stack, never grow it
+	if (length >= stack->length) {
+		return stack;
+	}
+
+	stack->length = length;
+
+	return Stack_shrink(stack);
 }
@@ -3,15 +3,24 @@
 
 typedef struct {
 	size_t length;
+	size_t capacity;
 	void *content[];
 } Stack;
 
 Stack *Stack_new();
 
+Stack *Stack_reserve(Stack*, size_t);
+
 Stack *Stack_push(Stack*, void*);
 
+Stack *Stack_append(Stack*, Stack*);
+
+Stack *Stack_copy(Stack*);
+
 Stack *Stack_pop(Stack*);
 
 Stack *Stack_delete(Stack*, size_t);
 
+Stack *Stack_truncate(Stack*, size_t);
+
 #endif
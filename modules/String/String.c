@@ -3,14 +3,57 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "String.h"
 
-// function to make and initialise a new String
-String *String_new(size_t length) {
-	String *new_string = malloc(sizeof(String) + length * sizeof(char));
+// function to make a new StringBuffer that can store a certain number of characters
+StringBuffer *StringBuffer_new(size_t capacity) {
+	StringBuffer *new_buffer = malloc(sizeof(StringBuffer) + capacity * sizeof(char));
+	new_buffer->references = 0;
+	new_buffer->capacity = capacity;
+	new_buffer->length = 0;
+	return new_buffer;
+}
+
+// function to make a new String that uses a certain part of a StringBuffer
+String *String_view(StringBuffer *buffer, size_t start, size_t length) {
+	String *new_string = malloc(sizeof(String));
 	new_string->length = length;
+	new_string->hash = 0;
+	new_string->content = &buffer->content[start];
+	new_string->buffer = buffer;
+
+	buffer->references++;
+
+	return new_string;
+}
+
+// function to make and initialise a new String with its own memory for its characters
+String *String_new(size_t length) {
+	StringBuffer *buffer = StringBuffer_new(length);
+	buffer->length = length;
+	return String_view(buffer, 0, length);
+}
+
+// function to free a String, along with the memory for its characters once no other String is using it
+void String_free(String *string) {
+	string->buffer->references--;
+	if (string->buffer->references == 0) {
+		free(string->buffer);
+	}
+
+	free(string);
+}
+
+// function to make a new String that contains a copy of some characters
+String *String_from(unsigned char *content, size_t length) {
+	String *new_string = String_new(length);
+	if (length > 0) {
+		memcpy(new_string->content, content, length);
+	}
 	return new_string;
 }
 
@@ -50,17 +93,76 @@ bool String_has_char(String* string, char character) {
 	return false;
 }
 
-// function to append a character to a String by reallocating the memory and assigning the character to the last byte
+// function to make a new String that contains some of the characters of a String, starting at a certain position
+// the new String shares its characters with the original String unless it would only use a small part of a large buffer, in which case it gets a copy of them instead so that the rest of the buffer can be free'd
+String *String_slice(String *string, size_t start, size_t length) {
+	if (length < string->buffer->capacity / 4) {
+		return String_from(&string->content[start], length);
+	}
+
+	return String_view(string->buffer, string->content - string->buffer->content + start, length);
+}
+
+// function to make a new String that contains the characters of a String followed by some other characters, without changing the original String
+// if the String ends where the characters stored in its buffer end and there is enough room after it, the new characters are stored straight after it and the new String shares the same buffer
+// otherwise, both are copied into a new buffer with room to spare, so that adding to the end of a String over and over again only takes linear time overall
+String *String_append(String *string, unsigned char *content, size_t length) {
+	StringBuffer *buffer = string->buffer;
+	size_t start = string->content - buffer->content;
+
+	if (start + string->length != buffer->length || buffer->length + length > buffer->capacity) {
+		size_t new_length = string->length + length;
+
+		buffer = StringBuffer_new(new_length < 8 ? 16 : new_length * 2);
+		memcpy(buffer->content, string->content, string->length);
+		buffer->length = string->length;
+		start = 0;
+	}
+
+	if (length > 0) {
+		memcpy(&buffer->content[buffer->length], content, length);
+	}
+	buffer->length += length;
+
+	return String_view(buffer, start, string->length + length);
+}
+
+// function to append a character to a String, giving back the new String and freeing the old one
 String *String_append_char(String *string, char character) {
-	string = realloc(string, sizeof(String) + (string->length + 1) * sizeof(char));
-	string->content[string->length] = character;
-	string->length++;
-	return string;
+	String *new_string = String_append(string, (unsigned char*)&character, 1);
+	String_free(string);
+	return new_string;
 }
 
-// function to print a String to the console by putchar()-ing every character in its contents
-void String_print(String *string) {
-	for (size_t i = 0; i < string->length; i++) {
-		putchar(string->content[i]);
+// function to get the hash of some characters using the FNV-1a algorithm
+// this gives the same result as String_hash() for a String with the same contents, so characters can be looked up without first being copied into a String
+size_t String_hash_content(unsigned char *content, size_t length) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= content[i];
+		hash *= 0x100000001b3ULL;
 	}
+
+	// make sure that a calculated hash can never be mistaken for one that hasn't been calculated
+	return hash == 0 ? 1 : hash;
+}
+
+// function to get the hash of the contents of a String
+// the hash is stored in the String the first time it is calculated, with zero meaning that it hasn't been calculated yet
+size_t String_hash(String *string) {
+	if (string->hash == 0) {
+		string->hash = String_hash_content(string->content, string->length);
+	}
+
+	return string->hash;
+}
+
+// function to write the contents of a String to a file in one go instead of one character at a time
+void String_write(String *string, FILE *file) {
+	fwrite(string->content, sizeof(char), string->length, file);
+}
+
+// function to print a String to the console
+void String_print(String *string) {
+	String_write(string, stdout);
 }
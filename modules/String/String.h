@@ -1,19 +1,48 @@
 #ifndef STRING_H
 #define STRING_H
 
+// memory that stores the characters of one or more Strings
+// Strings never change the characters that they can see, so several Strings can safely share the same memory
 typedef struct {
+	// the number of Strings that use this buffer
+	size_t references;
+
+	// the number of characters that can be stored in this buffer, and the number that have been stored so far
+	size_t capacity;
 	size_t length;
+
 	unsigned char content[];
+} StringBuffer;
+
+typedef struct {
+	size_t length;
+	size_t hash;
+	unsigned char *content;
+	StringBuffer *buffer;
 } String;
 
 String *String_new(size_t length);
 
+void String_free(String*);
+
+String *String_from(unsigned char*, size_t);
+
 bool String_is(String*, char*);
 
 bool String_has_char(String*, char);
 
+String *String_slice(String*, size_t, size_t);
+
+String *String_append(String*, unsigned char*, size_t);
+
 String *String_append_char(String*, char);
 
+size_t String_hash_content(unsigned char*, size_t);
+
+size_t String_hash(String*);
+
+void String_write(String*, FILE*);
+
 void String_print(String*);
 
 #endif